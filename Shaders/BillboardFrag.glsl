@@ -59,6 +59,8 @@ LAYUOT_BINDING(2) uniform _particlesData {
     float clippingDist;
     float zFar;
     float velIntensity;
+    vec4 qMin;
+    vec4 qScale;
 } u;
 
 
@@ -59,6 +59,8 @@ LAYUOT_BINDING(2) uniform _particlesData {
     float clippingDist;
     float zFar;
     float velIntensity;
+    vec4 qMin;
+    vec4 qScale;
 } u;
 
  
@@ -144,8 +146,9 @@ void main(void)
   //InfoIn = vec2(gl_MultiTexCoord0.w,gl_Vertex.w);
   //timeE = gl_MultiTexCoord1.y;
 
-    vec4 vtxPos = m.mvMatrix * vec4(a_ActualPoint.xyz,1.f);
-    float vel = a_ActualPoint.w*u.velIntensity;
+    vec4 pt = u.qMin + a_ActualPoint * u.qScale; // decode packed vertex (identity for float)
+    vec4 vtxPos = m.mvMatrix * vec4(pt.xyz,1.f);
+    float vel = pt.w*u.velIntensity;
 
 
 
@@ -58,6 +58,8 @@ LAYUOT_BINDING(2) uniform _particlesData {
     float clippingDist;
     float zFar;
     float velIntensity;
+    vec4 qMin;
+    vec4 qScale;
 } u;
 
 //#define _LIGHT_
@@ -66,6 +66,8 @@ LAYUOT_BINDING(2) uniform _particlesData {
     float clippingDist;
     float zFar;
     float velIntensity;
+    vec4 qMin;
+    vec4 qScale;
 } u;
 
 LAYUOT_BINDING(4) uniform _tMat { //shared?
@@ -97,8 +99,9 @@ out gl_PerVertex
 void main()                                                 
 {              
 
-    vec4 vtxPos = m.mvMatrix * vec4(a_ActualPoint.xyz,1.f);
-    float vel = a_ActualPoint.w*u.velIntensity;
+    vec4 pt = u.qMin + a_ActualPoint * u.qScale; // decode packed vertex (identity for float)
+    vec4 vtxPos = m.mvMatrix * vec4(pt.xyz,1.f);
+    float vel = pt.w*u.velIntensity;
 
     vec4 cOut = vec4(texture(paletteTex, vec2(vel,0.f)).rgb,1.0);
     
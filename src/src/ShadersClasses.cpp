@@ -206,6 +206,8 @@ void particlesBaseClass::render(GLuint fbOut, emitterBaseClass *emitter) {
     //getUData().velocity = getCMSettings()->getVelIntensity();
     if(checkFlagUpdate()) updateCommonUniforms();
     getUData().zFar = .5f/(getTMat()->getPOV().z-getTMat()->getTrackball().getDollyPosition().z); //1((/POV.z-Dolly.z)*2)
+    getUData().qMin   = emitter->getPacking().qMin;
+    getUData().qScale = emitter->getPacking().qScale;
     tMat.updateBufferData();
     updateBufferData();
        
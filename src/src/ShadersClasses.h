@@ -374,7 +374,7 @@ public:
     mergedRenderingClass *getMergedRendering() { return mergedRendering; }
     motionBlurClass *getMotionBlur() { return motionBlur; }
 
-    cmContainerClass &getColorMapContainer() { return colorMapContainer; }
+    cmContainerClass &getColorMapContainer() { return *colorMapContainer; }
 
 
     bool checkFlagUpdate() { return flagUpdate; }
@@ -402,7 +402,7 @@ protected:
     mergedRenderingClass *mergedRendering;
 
 
-    cmContainerClass colorMapContainer;
+    std::shared_ptr<cmContainerClass> colorMapContainer = cmContainerClass::getShared();
 
     GLuint texParticleID;
     bool flagUpdate;
@@ -729,6 +729,9 @@ struct uParticlesData {
     GLfloat clippingDist;
     GLfloat zFar;
     GLfloat velocity;
+    GLfloat pad[3];
+    vec4 qMin = vec4(0.f);   // packed vertex decode: qMin + v*qScale
+    vec4 qScale = vec4(1.f);
 };
 
 class uParticlesDataClass {
@@ -861,18 +864,18 @@ public:
     ColorMapSettingsClass *getCMSettings() { return colorMap; }
 
     void selectColorMap(int i) {
-        if(i>=colorMapContainer.elements()) i = 0;
+        if(i>=colorMapContainer->elements()) i = 0;
         colorMap->selected(i);
-        colorMap->buildTex(colorMapContainer.getRGB_pf3(i), colorMapContainer.getRGB_CMap3(i).size()/3); 
+        colorMap->buildTex(colorMapContainer->getRGB_pf3(i), colorMapContainer->getRGB_CMap3(i).size()/3); 
         setFlagUpdate(); colorMap->setFlagUpdate();
     }
     int getSelectedColorMap() { return colorMap->selected(); }
 
-    float *getSelectedColorMap_pf3()   { return colorMapContainer.getRGB_pf3  (colorMap->selected()); }
-    CMap3 &getSelectedColorMap_CMap3() { return colorMapContainer.getRGB_CMap3(colorMap->selected()); }
-    float *getColorMap_pf3(int i) { return colorMapContainer.getRGB_pf3(i); }
-    const char *getColorMap_name()      { return colorMapContainer.getName(colorMap->selected()); }
-    const char *getColorMap_name(int i) { return colorMapContainer.getName(i); }
+    float *getSelectedColorMap_pf3()   { return colorMapContainer->getRGB_pf3  (colorMap->selected()); }
+    CMap3 &getSelectedColorMap_CMap3() { return colorMapContainer->getRGB_CMap3(colorMap->selected()); }
+    float *getColorMap_pf3(int i) { return colorMapContainer->getRGB_pf3(i); }
+    const char *getColorMap_name()      { return colorMapContainer->getName(colorMap->selected()); }
+    const char *getColorMap_name(int i) { return colorMapContainer->getName(i); }
 
     bool getDepthState() { return depthBuffActive; }
     bool getBlendState() { return blendActive; }
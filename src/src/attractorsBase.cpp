@@ -30,91 +30,52 @@
 //  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
 //  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 //  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
-//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-//
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
 ////////////////////////////////////////////////////////////////////////////////
 #include <iostream>
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
 
-#include "glWindow.h"
+#include <glm/gtc/packing.hpp>
 
 #include "attractorsBase.h"
 
-AttractorsClass attractorsList; // need to resolve inlines
 //deque<glm::vec3> AttractorBase::stepQueue;
 
 //  Attractor base class
 ////////////////////////////////////////////////////////////////////////////
 
-//  Thread endless loop
-///////////////////////////////////////
-void AttractorsClass::endlessStep(emitterBaseClass *emitter)
+bool AttractorsClass::Step(float *ptr, uint numElements)
 {
-    //typedef void (AttractorBase::*threadStepPtrFn)(float *&ptr,vec3 &v, vec3 &vp);
-    typedef void (AttractorBase::*threadStepPtrFn)(float *&ptr,vec3 &v, vec3 &vp);
-
-    auto singleStep = [&] (float *ptr) -> void
-    {
-        //mtxStep.lock();
-
-        if(!emitter->isEmitterOn() || getSelection() < 0) return;
-
-        vec3 v = get()->getCurrent();
-        vec3 vp = v;
-
-#ifdef USE_MAPPED_BUFFER
-        GLuint64 &inc = *emitter->getVBO()->getPtrVertexUploaded();
-        const uint szBuffer = emitter->getSizeCircularBuffer(); 
-        uint countVtx = inc%szBuffer;
-        float *newPtr = ptr + countVtx * 4;
-        for(; countVtx<szBuffer && emitter->isEmitterOn() ; countVtx++, inc++) {
-            get()->Step(newPtr, v, vp);
-#else
-        for(uint &countVtx = get()->getRefEmittedParticles(); countVtx<emitter->getSizeStepBuffer() && emitter->isEmitterOn() && (!emitter->stopLoop()); countVtx++) {
-            get()->Step(ptr, v, vp);
-#endif
-            
-        }
-        get()->Insert(vp);
-        //mtxStep.unlock();
-    };       
-
-    while(endlessLoop) {
-        std::unique_lock<std::mutex> mlock(stepMutex);
-        stepCondVar.wait(mlock, std::bind(&emitterBaseClass::loopCanStart, emitter));
-
-        if(emitter->needRestartCircBuffer()) {
-            emitter->resetVBOindexes();
-            get()->initStep();
-            emitter->needRestartCircBuffer(false);
-        }
-
-#ifdef USE_MAPPED_BUFFER
-        //static bool needRestart = false;
-
-
-        singleStep(emitter->getVBO()->getBuffer()); 
-        if(emitter->isEmitterOn()) {
-            if(emitter->stopFull()) emitter->setEmitterOff();
-            if(emitter->restartCircBuff()) emitter->needRestartCircBuffer(true);
-        }
-#else
-
-
-        //cout << attractorsList.get()->getEmittedParticles() << " " << emitter->isBufferRendered() << " " << emitter->stopLoop() << endl;
-        emitter->setThreadRunning(true);
-
-        singleStep(emitter->getVBO()->getBuffer()); 
-
-        emitter->setThreadRunning(false);
-#endif
-    };
-    
+    AttractorBase *att = get();
+    if(orbits.isMultiOrbit()) orbits.checkSeeds(att);
+    const vec3 vGood = orbits.isMultiOrbit() ? orbits.getAt(0) : att->getCurrent();
+
+    while(true) {
+        if(orbits.isMultiOrbit()) {
+            float *p = ptr;
+            att->Step(p, orbits, numElements);
+            att->Insert(orbits.getAt(0));
+        } else 
+            att->Step(ptr, numElements);
+
+        const int h = checkEmissionHealth(ptr, numElements);
+        if(h == emitHealthy) return true;
+        if(!reportDeadOrbit(h)) break;
+        // dead orbit: again from a point near last good state
+        if(orbits.isMultiOrbit()) orbits.seed(att, vGood, true);
+        else att->Insert(reseedNear(vGood));
+    }
+    att->Insert(vGood);
+    return false;
 }
 
 void AttractorBase::resetQueue()
 {
     //stepQueue.clear();
-    stepQueue.resize(BUFFER_DIM,vec3(0.f,0.f,0.f));
+    stepGeneration++;
 }
 
 void AttractorBase::Step() 
@@ -142,97 +103,551 @@ void AttractorBase::Step(float *&ptr, vec3 &v, vec3 &vp)
     v = vp;
 }
 
+void AttractorBase::Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements) 
+{
+    while(numElements--) Step(ptr, v, vp); 
+}
+
 void AttractorBase::Step(float *ptr, int numElements) 
 {
     vec3 vp;
     vec3 v=getCurrent();
 
-    while(numElements--) Step(ptr, v, vp); 
+    Step(ptr, v, vp, numElements); 
 
     Insert(vec3(vp));
 }
 
+//  point i from orbit (i % nOrbits): same order of attractorKernel lanes
+void AttractorBase::Step(float *&ptr, multiOrbitClass &orbits, uint numElements) 
+{
+    const int nOrbits = orbits.getOrbits();
+    for(uint i=0; i<numElements; i++) {
+        const int orbit = i % nOrbits;
+        vec3 v(orbits.getAt(orbit)), vp;
+        Step(ptr, v, vp);
+        orbits.setAt(orbit, vp);
+    }
+}
+
+void multiOrbitClass::seed(AttractorBase *att, const vec3 &v0, bool jitterFirst)
+{
+    const float spread = MULTI_ORBIT_SPREAD * (1.f + length(v0));
+    auto jitter = [&] () -> float { return rnd.get(-spread, spread); };
+
+    for(int i=0; i<nOrbits; i++) 
+        setAt(i, (i || jitterFirst) ? v0 + vec3(jitter(), jitter(), jitter()) : v0);
+
+    owner = att;
+    generation = att->getStepGeneration();
+}
+
+//  Batch Step loops: STEP is a functor (v, vp) w/ the attractor step
+//  algorithm resolved at compile time
+////////////////////////////////////////////////////////////////////////////
+
+//  same sequence of AttractorBase::Step(ptr, v, vp), w/o stepFn indirection
+template <class STEP> inline void stepPoints(STEP step, float *&ptr, vec3 &v, vec3 &vp, uint numElements) 
+{
+    vec3 v0 = v, v1 = vp;
+    float *p = ptr;
+
+    while(numElements--) {
+        step(v0, v1);
+
+        *(p++) = v1.x;
+        *(p++) = v1.y;
+        *(p++) = v1.z;
+
+        *(p++) = distance(v0, v1);
+
+        v0 = v1;
+    }
+
+    v = v0; vp = v1; ptr = p;
+}
+
+//  Multi-orbit lanes: inner loop over SoA orbits is vectorized by compiler
+//  (needs -fno-math-errno for sqrt in distance), ISA selected at runtime
+////////////////////////////////////////////////////////////////////////////
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define ATT_SIMD_DISPATCH
+    #define ATT_TARGET_AVX2   __attribute__((target("avx2")))
+    #define ATT_TARGET_AVX512 __attribute__((target("avx512f")))
+    #define ATT_FORCE_INLINE  inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+    #define ATT_FORCE_INLINE  __forceinline
+#else
+    #define ATT_FORCE_INLINE  inline
+#endif
+
+enum { simdSSE, simdAVX2, simdAVX512 };
+
+static int getSimdLevel()
+{
+#ifdef ATT_SIMD_DISPATCH
+    static const int level = __builtin_cpu_supports("avx512f") ? simdAVX512 : 
+                            (__builtin_cpu_supports("avx2")    ? simdAVX2   : simdSSE);
+    return level;
+#else
+    return simdSSE;
+#endif
+}
+
+template <class STEP> ATT_FORCE_INLINE void stepOrbits(STEP step, float * __restrict ptr, 
+                                                       float * __restrict x, float * __restrict y, float * __restrict z, 
+                                                       const int nOrbits, uint nSteps)
+{
+    while(nSteps--) {
+        for(int i=0; i<nOrbits; i++) {
+            vec3 v(x[i], y[i], z[i]), vp;
+            step(v, vp);
+
+            ptr[i*4  ] = vp.x;
+            ptr[i*4+1] = vp.y;
+            ptr[i*4+2] = vp.z;
+            ptr[i*4+3] = distance(v, vp);
+
+            x[i] = vp.x; y[i] = vp.y; z[i] = vp.z;
+        }
+        ptr += nOrbits*4;
+    }
+}
+
+#ifdef ATT_SIMD_DISPATCH
+template <class STEP> ATT_TARGET_AVX2 void stepOrbitsAVX2(STEP step, float *ptr, float *x, float *y, float *z, const int nOrbits, uint nSteps)
+{
+    stepOrbits(step, ptr, x, y, z, nOrbits, nSteps);
+}
+
+template <class STEP> ATT_TARGET_AVX512 void stepOrbitsAVX512(STEP step, float *ptr, float *x, float *y, float *z, const int nOrbits, uint nSteps)
+{
+    stepOrbits(step, ptr, x, y, z, nOrbits, nSteps);
+}
+#endif
+
+template <class STEP> inline void stepOrbits(STEP step, float *&ptr, multiOrbitClass &orbits, uint numElements) 
+{
+    const int nOrbits = orbits.getOrbits();
+    const uint nSteps = numElements / nOrbits;
+    const int nTail = numElements % nOrbits;
+
+    switch(getSimdLevel()) {
+#ifdef ATT_SIMD_DISPATCH
+        case simdAVX512 : stepOrbitsAVX512(step, ptr, orbits.x, orbits.y, orbits.z, nOrbits, nSteps); break;
+        case simdAVX2   : stepOrbitsAVX2  (step, ptr, orbits.x, orbits.y, orbits.z, nOrbits, nSteps); break;
+#endif
+        default         : stepOrbits      (step, ptr, orbits.x, orbits.y, orbits.z, nOrbits, nSteps); break;
+    }
+    ptr += nSteps*nOrbits*4;
+
+    // remaining points: one more step on first nTail orbits
+    if(nTail) {
+        stepOrbits(step, ptr, orbits.x, orbits.y, orbits.z, nTail, 1);
+        ptr += nTail*4;
+    }
+}
+
+//  Attractor kernels
+////////////////////////////////////////////////////////////////////////////
+template <class ATT, class BASE> void attractorKernel<ATT, BASE>::Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements) 
+{
+    ATT *att = static_cast<ATT *>(this);
+    stepPoints([att] (vec3 &v, vec3 &vp) { att->ATT::Step(v, vp); }, ptr, v, vp, numElements);
+}
+
+template <class ATT, class BASE> void attractorKernel<ATT, BASE>::Step(float *&ptr, multiOrbitClass &orbits, uint numElements) 
+{
+    ATT *att = static_cast<ATT *>(this);
+    stepOrbits([att] (vec3 &v, vec3 &vp) { att->ATT::Step(v, vp); }, ptr, orbits, numElements);
+}
+
+//  precision selected once for each batch: MATH functions are inlined in loops
+//  functor w/ forced inline: a lambda w/ many sin/cos exceeds inline limits
+//  and blocks vectorization of the orbit lanes
+template <class ATT, class MATH> struct attractorMathStep {
+    ATT *att;
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const { att->template StepM<MATH>(v, vp); }
+};
+
+template <class F> inline void mathDispatch(int precision, F stepMath)
+{
+    switch(precision) {
+        case attMathFastest : stepMath(attMath<attMathFastest>()); break;
+        case attMathFast    : stepMath(attMath<attMathFast   >()); break;
+        default             : stepMath(attMath<attMathExact  >()); break;
+    }
+}
+
+template <class ATT, class BASE> void attractorMathKernel<ATT, BASE>::Step(vec3 &v, vec3 &vp) 
+{
+    ATT *att = static_cast<ATT *>(this);
+    mathDispatch(this->mathPrecision, [&] (auto math) { 
+        att->template StepM<decltype(math)>(v, vp); 
+    });
+}
+
+template <class ATT, class BASE> void attractorMathKernel<ATT, BASE>::Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements) 
+{
+    ATT *att = static_cast<ATT *>(this);
+    mathDispatch(this->mathPrecision, [&] (auto math) { 
+        stepPoints(attractorMathStep<ATT, decltype(math)> { att }, ptr, v, vp, numElements); 
+    });
+}
+
+template <class ATT, class BASE> void attractorMathKernel<ATT, BASE>::Step(float *&ptr, multiOrbitClass &orbits, uint numElements) 
+{
+    ATT *att = static_cast<ATT *>(this);
+    mathDispatch(this->mathPrecision, [&] (auto math) { 
+        stepOrbits(attractorMathStep<ATT, decltype(math)> { att }, ptr, orbits, numElements); 
+    });
+}
+
+//  d(x,y,z)/dt integrators: functors (v, vp) over a DERIV functor (v, dv)
+////////////////////////////////////////////////////////////////////////////
+template <class ATT> struct attractorDeriv {
+    ATT *att;
+    ATT_FORCE_INLINE void operator()(const vec3 &v, vec3 &dv) const { att->ATT::Deriv(v, dv); }
+};
+
+template <class ATT, class MATH> struct attractorMathDeriv {
+    ATT *att;
+    ATT_FORCE_INLINE void operator()(const vec3 &v, vec3 &dv) const { att->template DerivM<MATH>(v, dv); }
+};
+
+//  1 evaluation: same sequence of old v + dt*(...) Steps
+template <class DERIV> struct integrateEuler {
+    DERIV f; float h;
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const {
+        vec3 k;
+        f(v, k); 
+        vp = v + h*k;
+    }
+};
+
+//  4 evaluations, 4th order
+template <class DERIV> struct integrateRK4 {
+    DERIV f; float h;
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const {
+        const float h2 = h*.5f;
+        vec3 k1, k2, k3, k4;
+        f(v, k1);
+        f(v + h2*k1, k2);
+        f(v + h2*k2, k3);
+        f(v + h *k3, k4);
+        vp = v + (h/6.f)*(k1 + 2.f*(k2 + k3) + k4);
+    }
+};
+
+//  symmetric composition of two semi-implicit Euler half steps (x, y, z
+//  then z, y, x): 2nd order, time reversible, ~2 evaluations (unused
+//  components of each evaluation are discarded by compiler)
+template <class DERIV> struct integrateLeapfrog {
+    DERIV f; float h;
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const {
+        const float h2 = h*.5f;
+        vec3 x = v, k;
+        f(x, k); x.x += h2*k.x;
+        f(x, k); x.y += h2*k.y;
+        f(x, k); x.z += h2*k.z;
+        f(x, k); x.z += h2*k.z;
+        f(x, k); x.y += h2*k.y;
+        f(x, k); x.x += h2*k.x;
+        vp = x;
+    }
+};
+
+//  Cash-Karp RK45: dtStepInc is covered w/ substeps of h/2^n, halved while
+//  local error exceeds tolerance, doubled when well below (max 256 substeps)
+//  Points are still emitted each dtStepInc: loop is not vectorized
+template <class DERIV> struct integrateRK45 {
+    DERIV f; float h, tol;
+
+    static float maxAbs(const vec3 &v) { return std::max(std::max(std::abs(v.x), std::abs(v.y)), std::abs(v.z)); }
+
+    ATT_FORCE_INLINE void stepCK(const vec3 &v, float hs, vec3 &v5, vec3 &err) const {
+        vec3 k1, k2, k3, k4, k5, k6;
+        f(v, k1);
+        f(v + hs*(k1*(1.f/5.f)), k2);
+        f(v + hs*(k1*(3.f/40.f) + k2*(9.f/40.f)), k3);
+        f(v + hs*(k1*(3.f/10.f) - k2*(9.f/10.f) + k3*(6.f/5.f)), k4);
+        f(v + hs*(k1*(-11.f/54.f) + k2*(5.f/2.f) - k3*(70.f/27.f) + k4*(35.f/27.f)), k5);
+        f(v + hs*(k1*(1631.f/55296.f) + k2*(175.f/512.f) + k3*(575.f/13824.f) + k4*(44275.f/110592.f) + k5*(253.f/4096.f)), k6);
+
+        v5  = v + hs*(k1*(37.f/378.f) + k3*(250.f/621.f) + k4*(125.f/594.f) + k6*(512.f/1771.f));
+        err = hs*(k1*(37.f/378.f - 2825.f/27648.f) + k3*(250.f/621.f - 18575.f/48384.f) + 
+                  k4*(125.f/594.f - 13525.f/55296.f) - k5*(277.f/14336.f) + k6*(512.f/1771.f - .25f));
+    }
+
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const {
+        const float hMin = h*(1.f/256.f);
+        vec3 x = v, x5, err;
+        // substeps are h/2^n: left goes exactly to 0
+        for(float left = h, hs = h; left > 0.f; ) {
+            hs = std::min(hs, left);
+            stepCK(x, hs, x5, err);
+            const float e = maxAbs(err) / (tol * (1.f + maxAbs(x)));
+            if(e <= 1.f || hs <= hMin) {
+                x = x5; left -= hs;
+                if(e < 1.f/32.f) hs *= 2.f;     // 5th order: error * 32
+            } else hs *= .5f;
+        }
+        vp = x;
+    }
+};
+
+template <class DERIV, class F> inline void integratorDispatch(attractorDtType *att, DERIV deriv, F stepInt)
+{
+    const float h = att->getDtStepInc();
+    switch(att->getIntegrator()) {
+        case dtIntRK4      : stepInt(integrateRK4     <DERIV> { deriv, h }); break;
+        case dtIntRK45     : stepInt(integrateRK45    <DERIV> { deriv, h, att->getTolerance() }); break;
+        case dtIntLeapfrog : stepInt(integrateLeapfrog<DERIV> { deriv, h }); break;
+        default            : stepInt(integrateEuler   <DERIV> { deriv, h }); break;
+    }
+}
+
+template <class ATT, class F> inline void derivDispatch(ATT *att, std::false_type, F stepDeriv)
+{
+    stepDeriv(attractorDeriv<ATT> { att });
+}
+
+template <class ATT, class F> inline void derivDispatch(ATT *att, std::true_type, F stepDeriv)
+{
+    mathDispatch(att->getMathPrecision(), [&] (auto math) { 
+        stepDeriv(attractorMathDeriv<ATT, decltype(math)> { att }); 
+    });
+}
+
+//  integrator (and precision) selected once for each batch
+template <class ATT, bool MATH, class F> inline void dtDispatch(ATT *att, F stepInt)
+{
+    derivDispatch(att, std::integral_constant<bool, MATH>(), [&] (auto deriv) { 
+        integratorDispatch(att, deriv, stepInt); 
+    });
+}
+
+//  arc-length emission: steps until trajectory has advanced arc, then a point
+//  is emitted. v is left at start of last step: 4th component of the point
+//  is last step distance (speed), as in plain emission
+template <class STEP> struct emitArcLength {
+    STEP step; float arc;
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const {
+        float s = 0.f;
+        for(int n = DT_ARC_MAX_SUBSTEPS; ; v = vp) {
+            step(v, vp);
+            s += distance(v, vp);
+            if(s >= arc || !--n) break;
+        }
+    }
+};
+
+//  batch emission: a point for each step or for each arcLength
+template <class ATT, bool MATH, class F> inline void dtEmitDispatch(ATT *att, F stepEmit)
+{
+    const float arc = att->getArcLength();
+    dtDispatch<ATT, MATH>(att, [&] (auto step) { 
+        if(arc > 0.f) stepEmit(emitArcLength<decltype(step)> { step, arc });
+        else          stepEmit(step);
+    });
+}
+
+template <class ATT, bool MATH> void attractorDtKernel<ATT, MATH>::Step(vec3 &v, vec3 &vp) 
+{
+    dtDispatch<ATT, MATH>(static_cast<ATT *>(this), [&] (auto step) { step(v, vp); });
+}
+
+template <class ATT, bool MATH> void attractorDtKernel<ATT, MATH>::Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements) 
+{
+    dtEmitDispatch<ATT, MATH>(static_cast<ATT *>(this), [&] (auto step) { stepPoints(step, ptr, v, vp, numElements); });
+}
+
+template <class ATT, bool MATH> void attractorDtKernel<ATT, MATH>::Step(float *&ptr, multiOrbitClass &orbits, uint numElements) 
+{
+    dtEmitDispatch<ATT, MATH>(static_cast<ATT *>(this), [&] (auto step) { stepOrbits(step, ptr, orbits, numElements); });
+}
+
+//  Lyapunov exponent: searchLyapunov and lyapunov maps
+////////////////////////////////////////////////////////////////////////////
+#define LYAPUNOV_EXIT_VAL 1000.f
+
+//  from current point: orbit escapes (or NaN) or converges to single point
+bool AttractorBase::lyapunovDivergent(int nSteps)
+{
+    const float exitVal = LYAPUNOV_EXIT_VAL;
+    for(int i=0; i<nSteps; i++) {
+        AttractorBase::Step();
+        vec3 v(getCurrent());
+        vec3 p(getPrevious());
+        if (!(fabs(v.x) <= exitVal && fabs(v.y) <= exitVal && fabs(v.z) <= exitVal) || 
+            (i>1 && distance(v,p) < FLT_EPSILON) /*|| distance(v,a) <.001 */) return true;
+    }
+    return false;
+}
+
+//  largest exponent (bits/step), ve at distance d0 from orbit: NaN if orbit escapes
+//  chaotic: exits as soon as exponent is in range of searchLyapunov
+float AttractorBase::lyapunovExponent(vec3 ve, float d0, int nSteps, bool *chaotic)
+{
+    const float exitVal = LYAPUNOV_EXIT_VAL;
+    float lyapunov = 0.0;
+    int nL = 1;
+
+    for(int i=1; i<nSteps; i++) {
+        AttractorBase::Step();             
+        vec3 v(getCurrent()); // saving v (current value of attractor)
+
+        if(!(fabs(v.x) <= exitVal && fabs(v.y) <= exitVal && fabs(v.z) <= exitVal)) return NAN;
+
+        // compute vepsilon insering ve on queue
+        Insert(ve);
+        AttractorBase::Step();             
+        vec3 veNew(getCurrent());
+
+        Insert(v); // reinsert v on queue
+
+        vec3 vd(v - veNew);
+        const float dd = length(vd);
+
+        if(fabs(d0)>FLT_EPSILON && fabs(dd)>FLT_EPSILON) {
+            //lyapunov += .721347 * log(fabs(dd / d0));
+            lyapunov += .721347 * log(dd / d0);
+            nL++;
+        }
+
+        ve = v + d0 * vd / dd;
+
+        if(chaotic && i>1500 && nL> 1350 && ((lyapunov)/nL < 1.0 && lyapunov/nL > 0.015)) {
+            *chaotic = true;
+            break;
+        }
+    }
+    return lyapunov/nL;
+}
+
 void AttractorBase::searchLyapunov()
 {
     vec3 ve;
     float d0;
     bool canExit = false, restart;
-    const float exitVal = 1000.f;
     const int maxIter = 100000;
     int iter = maxIter;
-    int counted = 0;
+    auto cancelled = [&] () { return searchCancel && searchCancel->load(std::memory_order_relaxed); };
+    searchFound = false;
     do {
         do { //testing if diverfgent or convergent to single ponit
-            newRandomValues();
+            randomValues(attRng().nextSeed());
             initStep();
             vec3 v0(getCurrent());
             ve = vec3(v0 + (vec3(RANDOM(kMin,kMax),RANDOM(kMin,kMax),RANDOM(kMin,kMax))/1000.f));
             d0 = distance(v0,ve);
-            restart = false;
-            for(int i=0; i<300; i++) {
-                AttractorBase::Step();
-                vec3 v(getCurrent());
-                vec3 p(getPrevious());
-                if (v.x > exitVal || v.y > exitVal || v.z > exitVal || 
-                    v.x <-exitVal || v.y <-exitVal || v.z <-exitVal || (i>1 && distance(v,p) < FLT_EPSILON) /*|| distance(v,a) <.001 */) {
-                    restart = true;
-                    iter--;
-                    break;
-                }  
-            }
-        } while(restart && iter>0);
+            restart = lyapunovDivergent(300);
+            if(restart) iter--;
+        } while(restart && iter>0 && !cancelled());
+
+        if(cancelled()) return;
 
         canExit = false;
-        counted++;
+        lyapunovExponent(ve, d0, 2000, &canExit);
+    } while(!canExit && iter-->0 && !cancelled());
+
+    searchFound = canExit;
+}
 
-        float lyapunov = 0.0;
-        float fSpace;
-        int nL = 1;
+//  Random attractors search in background
+////////////////////////////////////////////////////////////////////////////
+Config attractorSearchClass::searchSettings(AttractorBase *att)
+{
+    Config cfg = Config::object();
+    att->saveVals(cfg);
+    // values are results of the search, all other keys are its settings
+    cfg.erase("vData");
+    cfg.erase("kData");
+    cfg.erase("seed");
+    return cfg;
+}
 
-        for(int i=1; i<2000; i++) {
-            AttractorBase::Step();             
-            vec3 v(getCurrent()); // saving v (current value of attractor)
+void attractorSearchClass::start(AttractorBase *att, int nThreads)
+{
+    stop();
 
-            // compute vepsilon insering ve on queue
-            Insert(ve);
-            AttractorBase::Step();             
-            vec3 veNew(getCurrent());
+    if(nThreads<=0) nThreads = std::max(int(std::thread::hardware_concurrency())-1, 1);
 
-            Insert(v); // reinsert v on queue
+    Config cfg = Config::object();
+    att->saveVals(cfg);
+    settings = searchSettings(att);
 
-            vec3 vd(v - veNew);
-            const float dd = length(vd);
+    found = 0;
+    for(int i=0; i<nThreads; i++) workers.push_back(new thread(&attractorSearchClass::worker, this, cfg));
+}
 
-            if(fabs(d0)>FLT_EPSILON && fabs(dd)>FLT_EPSILON) {
-                //lyapunov += .721347 * log(fabs(dd / d0));
-                lyapunov += .721347 * log(dd / d0);
-                nL++;
-            }
+void attractorSearchClass::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        cancel = true;
+    }
+    resultsCondVar.notify_all();
 
-            ve = v + d0 * vd / dd;
+    for(auto w : workers) { w->join(); delete w; }
+    workers.clear();
 
-            //if(!(i%1000)) cout << "i: " <<  i << " - LExp: " << lyapunov/nL << " - L: " <<  nL << endl;
+    results.clear();
+    cancel = false;
+}
 
-            if( i>1500 && nL> 1350 && ((lyapunov)/nL < 1.0 && lyapunov/nL > 0.015)) {
-                cout << "berak: " << lyapunov/nL << " - L: " <<  nL << " - i: " <<  i << endl;
-                canExit = true;
-                break;
-            }
-        }
-        //lyapunov/=nL;
-        //cout << "LyapExp: " << lyapunov << endl;
-         cout << counted << " - " << maxIter - iter << endl;
-    } while(!canExit && iter-->0);
+bool attractorSearchClass::isSameSearch(AttractorBase *att)
+{
+    return isRunning() && searchSettings(att) == settings;
+}
+
+bool attractorSearchClass::popResult(Config &cfg)
+{
+    {
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        if(results.empty()) return false;
+        cfg = std::move(results.front());
+        results.pop_front();
+    }
+    resultsCondVar.notify_one();
+    return true;
+}
+
+void attractorSearchClass::worker(Config cfg)
+{
+    AttractorBase *att = AttractorsClass::newAttractor((std::string)cfg.get_or("Name",""));
+    if(!att) return;
+
+    att->loadVals(cfg);
+    att->setSearchCancel(&cancel);
+
+    while(!cancel) {
+        att->randomValues(attRng().nextSeed());
+        att->initStep();
+        att->searchAttractor();
+        if(cancel || !att->isSearchFound()) continue;
+
+        Config c = Config::object();
+        att->saveVals(c);
+
+        std::unique_lock<std::mutex> lock(resultsMutex);
+        resultsCondVar.wait(lock, [&] { return cancel || results.size() < SEARCH_MAX_RESULTS; });
+        if(cancel) break;
+        results.push_back(std::move(c));
+        found++;
+    }
+
+    delete att;
 }
 
 
 //  Lorenz Attractor
 ////////////////////////////////////////////////////////////////////////////
-inline void Lorenz::Step(vec3 &v, vec3 &vp)
+inline void Lorenz::Deriv(const vec3 &v, vec3 &dv)
 {
-    vp.x = v.x+dtStepInc*(kVal[0]*(v.y-v.x));
-    vp.y = v.y+dtStepInc*(v.x*(kVal[1]-v.z)-v.y);
-    vp.z = v.z+dtStepInc*(v.x*v.y-kVal[2]*v.z);
+    dv.x = kVal[0]*(v.y-v.x);
+    dv.y = v.x*(kVal[1]-v.z)-v.y;
+    dv.z = v.x*v.y-kVal[2]*v.z;
 }
 
 //  Hopalong Attractor
@@ -314,25 +729,94 @@ inline void Hopalong::Step(float *&ptr, vec3 &v, vec3 &vp) {
 
 //  PowerN3D Attractor
 ////////////////////////////////////////////////////////////////////////////
-inline void PowerN3D::Step(vec3 &v, vec3 &vp) 
+//  monomials of order O in same sequence of StepN, kVal[I] coefficient:
+//      x^X y^Y z^Z, X Y Z from O-1 to 0 w/ X+Y+Z <= O, then x^O, y^O, z^O
+//  expanded at compile time: no tests and no coefficients table in Step
+template <int O, int X, int Y, int Z, int I> struct powerN3DMonomials {
+    enum { used = X+Y+Z <= O,
+           nX = (Z>0 || Y>0) ? X : X-1,
+           nY = Z>0 ? Y : (Y>0 ? Y-1 : O-1),
+           nZ = Z>0 ? Z-1 : O-1 };
+
+    static ATT_FORCE_INLINE void eval(const float *px, const float *py, const float *pz, const vec3 *k, vec3 &vp) {
+        if(used) vp += k[I] * (px[X] * py[Y] * pz[Z]);
+        powerN3DMonomials<O, nX, nY, nZ, I+used>::eval(px, py, pz, k, vp);
+    }
+};
+
+template <int O, int Y, int Z, int I> struct powerN3DMonomials<O, -1, Y, Z, I> {
+    static ATT_FORCE_INLINE void eval(const float *px, const float *py, const float *pz, const vec3 *k, vec3 &vp) {
+        vp += k[I  ] * px[O];
+        vp += k[I+1] * py[O];
+        vp += k[I+2] * pz[O];
+    }
+};
+
+template <int O> struct powerN3DStep {
+    const vec3 *k;
+
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const {
+        float px[O+1], py[O+1], pz[O+1];
+        px[0] = py[0] = pz[0] = 1.f;
+        for(int i=1; i<=O; i++) { px[i] = px[i-1]*v.x; py[i] = py[i-1]*v.y; pz[i] = pz[i-1]*v.z; }
+
+        vp = vec3(0.f);
+        powerN3DMonomials<O, O-1, O-1, O-1, 0>::eval(px, py, pz, k, vp);
+    }
+};
+
+//  generic order (0)
+template <> struct powerN3DStep<0> {
+    PowerN3D *att;
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const { att->StepN(v, vp); }
+};
+
+template <class F> inline void orderDispatch(int order, F stepOrder)
 {
-    elv[0] = vec3(1.f);
-    for(int i=1; i<=order; i++) elv[i] = elv[i-1] * v;
+    switch(order) {
+        case 2 : stepOrder(std::integral_constant<int, 2>()); break;
+        case 3 : stepOrder(std::integral_constant<int, 3>()); break;
+        case 4 : stepOrder(std::integral_constant<int, 4>()); break;
+        case 5 : stepOrder(std::integral_constant<int, 5>()); break;
+        case 6 : stepOrder(std::integral_constant<int, 6>()); break;
+        case 7 : stepOrder(std::integral_constant<int, 7>()); break;
+        case 8 : stepOrder(std::integral_constant<int, 8>()); break;
+        default: stepOrder(std::integral_constant<int, 0>()); break;
+    }
+}
+
+template <int O> inline powerN3DStep<O> powerN3DFunctor(PowerN3D *att, const vec3 *k) { return powerN3DStep<O> { k }; }
+template <> inline powerN3DStep<0> powerN3DFunctor<0>(PowerN3D *att, const vec3 *k) { return powerN3DStep<0> { att }; }
+
+void PowerN3D::Step(vec3 &v, vec3 &vp) 
+{
+    orderDispatch(order, [&] (auto o) { powerN3DFunctor<decltype(o)::value>(this, kVal.data())(v, vp); });
+}
 
-    auto itCf = cf.begin();
-    for(int x=order-1; x>=0; x--)
-        for(int y=order-1; y>=0; y--)
-            for(int z=order-1; z>=0; z--) 
-                if(x+y+z <= order) *itCf++ = elv[x].x * elv[y].y * elv[z].z;
+void PowerN3D::Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements) 
+{
+    orderDispatch(order, [&] (auto o) { stepPoints(powerN3DFunctor<decltype(o)::value>(this, kVal.data()), ptr, v, vp, numElements); });
+}
+
+void PowerN3D::Step(float *&ptr, multiOrbitClass &orbits, uint numElements) 
+{
+    orderDispatch(order, [&] (auto o) { stepOrbits(powerN3DFunctor<decltype(o)::value>(this, kVal.data()), ptr, orbits, numElements); });
+}
+
+//  any order
+void PowerN3D::StepN(vec3 &v, vec3 &vp) 
+{
+    // scratch per thread: Step is called concurrently by emission workers
+    static thread_local vector<vec3> elv;
+    elv.resize(order+1);
 
-    *itCf++ = elv[order].x;
-    *itCf++ = elv[order].y;
-    *itCf++ = elv[order].z;
+    elv[0] = vec3(1.f);
+    for(int i=1; i<=order; i++) elv[i] = elv[i-1] * v;
 
     vp = vec3(0.f);
 
-    itCf = cf.begin();
-    for(auto &it : kVal) vp += it * *itCf++;
+    const int *e = monomials.data();
+    for(auto &it : kVal) { vp += it * (elv[e[0]].x * elv[e[1]].y * elv[e[2]].z); e+=3; }
 }
 
 /*
@@ -373,432 +857,579 @@ inline void PolynomialABS::Step(vec3 &v, vec3 &vp)
     vp.z = kVal[0].z + kVal[1].z*v.x + kVal[2].z*v.y + kVal[3].z*v.z + kVal[4].z*abs(v.x) + kVal[5].z*abs(v.y) +kVal[6].z*abs(v.z);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void PolynomialPow::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void PolynomialPow::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = kVal[0].x + kVal[1].x*v.x + kVal[2].x*v.y + kVal[3].x*v.z + kVal[4].x*abs(v.x) + kVal[5].x*abs(v.y) +kVal[6].x*pow(abs(v.z),kVal[7].x);
-    vp.y = kVal[0].y + kVal[1].y*v.x + kVal[2].y*v.y + kVal[3].y*v.z + kVal[4].y*abs(v.x) + kVal[5].y*abs(v.y) +kVal[6].y*pow(abs(v.z),kVal[7].y);
-    vp.z = kVal[0].z + kVal[1].z*v.x + kVal[2].z*v.y + kVal[3].z*v.z + kVal[4].z*abs(v.x) + kVal[5].z*abs(v.y) +kVal[6].z*pow(abs(v.z),kVal[7].z);
+    vp.x = kVal[0].x + kVal[1].x*v.x + kVal[2].x*v.y + kVal[3].x*v.z + kVal[4].x*abs(v.x) + kVal[5].x*abs(v.y) +kVal[6].x*MATH::pow(abs(v.z),kVal[7].x);
+    vp.y = kVal[0].y + kVal[1].y*v.x + kVal[2].y*v.y + kVal[3].y*v.z + kVal[4].y*abs(v.x) + kVal[5].y*abs(v.y) +kVal[6].y*MATH::pow(abs(v.z),kVal[7].y);
+    vp.z = kVal[0].z + kVal[1].z*v.x + kVal[2].z*v.y + kVal[3].z*v.z + kVal[4].z*abs(v.x) + kVal[5].z*abs(v.y) +kVal[6].z*MATH::pow(abs(v.z),kVal[7].z);
 
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void PolynomialSin::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void PolynomialSin::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = kVal[0].x + kVal[1].x*v.x + kVal[2].x*v.y + kVal[3].x*v.z + kVal[4].x*sin(kVal[5].x*kVal[6].x*v.x) + kVal[7].x*sin(kVal[8].x*kVal[9].x*v.y) +kVal[10].x*sin(kVal[11].x*kVal[12].x*v.z);
-    vp.y = kVal[0].y + kVal[1].y*v.x + kVal[2].y*v.y + kVal[3].y*v.z + kVal[4].y*sin(kVal[5].y*kVal[6].y*v.x) + kVal[7].y*sin(kVal[8].y*kVal[9].y*v.y) +kVal[10].y*sin(kVal[11].y*kVal[12].y*v.z);
-    vp.z = kVal[0].z + kVal[1].z*v.x + kVal[2].z*v.y + kVal[3].z*v.z + kVal[4].z*sin(kVal[5].z*kVal[6].z*v.x) + kVal[7].z*sin(kVal[8].z*kVal[9].z*v.y) +kVal[10].z*sin(kVal[11].z*kVal[12].z*v.z);
+    vp.x = kVal[0].x + kVal[1].x*v.x + kVal[2].x*v.y + kVal[3].x*v.z + kVal[4].x*MATH::sin(kVal[5].x*kVal[6].x*v.x) + kVal[7].x*MATH::sin(kVal[8].x*kVal[9].x*v.y) +kVal[10].x*MATH::sin(kVal[11].x*kVal[12].x*v.z);
+    vp.y = kVal[0].y + kVal[1].y*v.x + kVal[2].y*v.y + kVal[3].y*v.z + kVal[4].y*MATH::sin(kVal[5].y*kVal[6].y*v.x) + kVal[7].y*MATH::sin(kVal[8].y*kVal[9].y*v.y) +kVal[10].y*MATH::sin(kVal[11].y*kVal[12].y*v.z);
+    vp.z = kVal[0].z + kVal[1].z*v.x + kVal[2].z*v.y + kVal[3].z*v.z + kVal[4].z*MATH::sin(kVal[5].z*kVal[6].z*v.x) + kVal[7].z*MATH::sin(kVal[8].z*kVal[9].z*v.y) +kVal[10].z*MATH::sin(kVal[11].z*kVal[12].z*v.z);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe01::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe01::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*sin(kVal[0].x*v.x)+cos(kVal[1].x*v.y);
-    vp.y = v.x*sin(kVal[0].y*v.y)+cos(kVal[1].y*v.z);
-    vp.z = v.y*sin(kVal[0].z*v.z)+cos(kVal[1].z*v.x);
+    vp.x = v.z*MATH::sin(kVal[0].x*v.x)+MATH::cos(kVal[1].x*v.y);
+    vp.y = v.x*MATH::sin(kVal[0].y*v.y)+MATH::cos(kVal[1].y*v.z);
+    vp.z = v.y*MATH::sin(kVal[0].z*v.z)+MATH::cos(kVal[1].z*v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe02::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe02::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*sin(kVal[0].x*v.x)+acos(kVal[1].x*v.y);
-    vp.y = v.x*sin(kVal[0].y*v.y)+acos(kVal[1].y*v.z);
-    vp.z = v.y*sin(kVal[0].z*v.z)+acos(kVal[1].z*v.x);
+    vp.x = v.z*MATH::sin(kVal[0].x*v.x)+MATH::acos(kVal[1].x*v.y);
+    vp.y = v.x*MATH::sin(kVal[0].y*v.y)+MATH::acos(kVal[1].y*v.z);
+    vp.z = v.y*MATH::sin(kVal[0].z*v.z)+MATH::acos(kVal[1].z*v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe03::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe03::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.x*v.z*sin(kVal[0].x*v.x)-cos(kVal[1].x*v.y);
-    vp.y = v.y*v.x*sin(kVal[0].y*v.y)-cos(kVal[1].y*v.z);
-    vp.z = v.z*v.y*sin(kVal[0].z*v.z)-cos(kVal[1].z*v.x);
+    vp.x = v.x*v.z*MATH::sin(kVal[0].x*v.x)-MATH::cos(kVal[1].x*v.y);
+    vp.y = v.y*v.x*MATH::sin(kVal[0].y*v.y)-MATH::cos(kVal[1].y*v.z);
+    vp.z = v.z*v.y*MATH::sin(kVal[0].z*v.z)-MATH::cos(kVal[1].z*v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe03A::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe03A::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*v.z*sin(kVal[0].x*v.x)-cos(kVal[1].x*v.y);
-    vp.y = v.x*v.x*sin(kVal[0].y*v.y)-cos(kVal[1].y*v.z);
-    vp.z = v.y*v.y*sin(kVal[0].z*v.z)-cos(kVal[1].z*v.x);
+    vp.x = v.z*v.z*MATH::sin(kVal[0].x*v.x)-MATH::cos(kVal[1].x*v.y);
+    vp.y = v.x*v.x*MATH::sin(kVal[0].y*v.y)-MATH::cos(kVal[1].y*v.z);
+    vp.z = v.y*v.y*MATH::sin(kVal[0].z*v.z)-MATH::cos(kVal[1].z*v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe04::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe04::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*sin(kVal[0].x*v.x)+cos(kVal[1].x*v.y);
-    vp.y = v.x*sin(kVal[0].y*v.y)+cos(kVal[1].y*v.z);
-    vp.z = v.y*sin(kVal[0].z*v.z)+cos(kVal[1].z*v.x);
+    vp.x = v.z*MATH::sin(kVal[0].x*v.x)+MATH::cos(kVal[1].x*v.y);
+    vp.y = v.x*MATH::sin(kVal[0].y*v.y)+MATH::cos(kVal[1].y*v.z);
+    vp.z = v.y*MATH::sin(kVal[0].z*v.z)+MATH::cos(kVal[1].z*v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe05::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe05::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*sin(kVal[0].x*v.x)+cos(kVal[1].x*v.y)+sin(kVal[2].x*v.z);
-    vp.y = v.x*sin(kVal[0].y*v.x)+cos(kVal[1].y*v.y)+sin(kVal[2].y*v.z);
-    vp.z = v.y*sin(kVal[0].z*v.x)+cos(kVal[1].z*v.y)+sin(kVal[2].z*v.z);
+    vp.x = v.z*MATH::sin(kVal[0].x*v.x)+MATH::cos(kVal[1].x*v.y)+MATH::sin(kVal[2].x*v.z);
+    vp.y = v.x*MATH::sin(kVal[0].y*v.x)+MATH::cos(kVal[1].y*v.y)+MATH::sin(kVal[2].y*v.z);
+    vp.z = v.y*MATH::sin(kVal[0].z*v.x)+MATH::cos(kVal[1].z*v.y)+MATH::sin(kVal[2].z*v.z);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe06::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe06::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*sin(kVal[0].x*v.x)-cos(kVal[1].x*v.y);
-    vp.y = v.x*sin(kVal[0].y*v.y)+cos(kVal[1].y*v.z);
-    vp.z = v.y*sin(kVal[0].z*v.z)-cos(kVal[1].z*v.x);
+    vp.x = v.z*MATH::sin(kVal[0].x*v.x)-MATH::cos(kVal[1].x*v.y);
+    vp.y = v.x*MATH::sin(kVal[0].y*v.y)+MATH::cos(kVal[1].y*v.z);
+    vp.z = v.y*MATH::sin(kVal[0].z*v.z)-MATH::cos(kVal[1].z*v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe07::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe07::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*sin(kVal[0].x*v.x)-cos(kVal[1].x*v.y);
-    vp.y = v.x*cos(kVal[0].y*v.y)+sin(kVal[1].y*v.z);
-    vp.z = v.y*sin(kVal[0].z*v.z)-cos(kVal[1].z*v.x);
+    vp.x = v.z*MATH::sin(kVal[0].x*v.x)-MATH::cos(kVal[1].x*v.y);
+    vp.y = v.x*MATH::cos(kVal[0].y*v.y)+MATH::sin(kVal[1].y*v.z);
+    vp.z = v.y*MATH::sin(kVal[0].z*v.z)-MATH::cos(kVal[1].z*v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe08::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe08::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*sin(kVal[0].x*v.x)-cos(v.y);
-    vp.y = v.x*cos(kVal[0].y*v.y)+sin(v.z);
-    vp.z = v.y*sin(kVal[0].z*v.z)-cos(v.x);
+    vp.x = v.z*MATH::sin(kVal[0].x*v.x)-MATH::cos(v.y);
+    vp.y = v.x*MATH::cos(kVal[0].y*v.y)+MATH::sin(v.z);
+    vp.z = v.y*MATH::sin(kVal[0].z*v.z)-MATH::cos(v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe09::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe09::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*sin(kVal[0].x*v.x)-acos(kVal[1].x*v.y)+sin(kVal[2].x*v.z);
-    vp.y = v.x*sin(kVal[0].y*v.x)-acos(kVal[1].y*v.y)+sin(kVal[2].y*v.z);
-    vp.z = v.y*sin(kVal[0].z*v.x)-acos(kVal[1].z*v.y)+sin(kVal[2].z*v.z);
+    vp.x = v.z*MATH::sin(kVal[0].x*v.x)-MATH::acos(kVal[1].x*v.y)+MATH::sin(kVal[2].x*v.z);
+    vp.y = v.x*MATH::sin(kVal[0].y*v.x)-MATH::acos(kVal[1].y*v.y)+MATH::sin(kVal[2].y*v.z);
+    vp.z = v.y*MATH::sin(kVal[0].z*v.x)-MATH::acos(kVal[1].z*v.y)+MATH::sin(kVal[2].z*v.z);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rampe10::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void Rampe10::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = v.z*v.y*sin(kVal[0].x*v.x)-cos(kVal[1].x*v.y)+asin(kVal[2].x*v.z);
-    vp.y = v.x*v.z*sin(kVal[0].y*v.x)-cos(kVal[1].y*v.y)+ sin(kVal[2].y*v.z);
-    vp.z = v.y*v.x*sin(kVal[0].z*v.x)-cos(kVal[1].z*v.y)+ sin(kVal[2].z*v.z);
+    vp.x = v.z*v.y*MATH::sin(kVal[0].x*v.x)-MATH::cos(kVal[1].x*v.y)+MATH::asin(kVal[2].x*v.z);
+    vp.y = v.x*v.z*MATH::sin(kVal[0].y*v.x)-MATH::cos(kVal[1].y*v.y)+ MATH::sin(kVal[2].y*v.z);
+    vp.z = v.y*v.x*MATH::sin(kVal[0].z*v.x)-MATH::cos(kVal[1].z*v.y)+ MATH::sin(kVal[2].z*v.z);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void KingsDream::Step(vec3 &v, vec3 &vp)
+template <class MATH> ATT_FORCE_INLINE void KingsDream::StepM(vec3 &v, vec3 &vp)
 {
-    vp.x = sin(v.z * kVal[0]) + kVal[3] * sin(v.x * kVal[0]);
-    vp.y = sin(v.x * kVal[1]) + kVal[4] * sin(v.y * kVal[1]);
-    vp.z = sin(v.y * kVal[2]) + kVal[5] * sin(v.z * kVal[2]);
+    vp.x = MATH::sin(v.z * kVal[0]) + kVal[3] * MATH::sin(v.x * kVal[0]);
+    vp.y = MATH::sin(v.x * kVal[1]) + kVal[4] * MATH::sin(v.y * kVal[1]);
+    vp.z = MATH::sin(v.y * kVal[2]) + kVal[5] * MATH::sin(v.z * kVal[2]);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Pickover::Step(vec3 &v, vec3 &vp) 
+template <class MATH> ATT_FORCE_INLINE void Pickover::StepM(vec3 &v, vec3 &vp) 
 {
-    vp.x =     sin(kVal[0]*v.y) - v.z*cos(kVal[1]*v.x);
-    vp.y = v.z*sin(kVal[2]*v.x) -     cos(kVal[3]*v.y);
-    vp.z =     sin(v.x)                               ;
+    vp.x =     MATH::sin(kVal[0]*v.y) - v.z*MATH::cos(kVal[1]*v.x);
+    vp.y = v.z*MATH::sin(kVal[2]*v.x) -     MATH::cos(kVal[3]*v.y);
+    vp.z =     MATH::sin(v.x)                               ;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void SinCos::Step(vec3 &v, vec3 &vp) 
+template <class MATH> ATT_FORCE_INLINE void SinCos::StepM(vec3 &v, vec3 &vp) 
 {
-    vp.x =  cos(kVal[0]*v.x) + sin(kVal[1]*v.y) - sin(kVal[2]*v.z);
-    vp.y =  sin(kVal[3]*v.x) - cos(kVal[4]*v.y) + sin(kVal[5]*v.z);
-    vp.z = -cos(kVal[6]*v.x) + cos(kVal[7]*v.y) + cos(kVal[8]*v.z);
+    vp.x =  MATH::cos(kVal[0]*v.x) + MATH::sin(kVal[1]*v.y) - MATH::sin(kVal[2]*v.z);
+    vp.y =  MATH::sin(kVal[3]*v.x) - MATH::cos(kVal[4]*v.y) + MATH::sin(kVal[5]*v.z);
+    vp.z = -MATH::cos(kVal[6]*v.x) + MATH::cos(kVal[7]*v.y) + MATH::cos(kVal[8]*v.z);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void ChenLee::Step(vec3 &v, vec3 &vp) 
+inline void ChenLee::Deriv(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*(kVal[0]*v.x - v.y*v.z);
-    vp.y = v.y + dtStepInc*(kVal[1]*v.y + v.x*v.z);
-    vp.z = v.z + dtStepInc*(kVal[2]*v.z + v.x*v.y/3.f);
+    dv.x = kVal[0]*v.x - v.y*v.z;
+    dv.y = kVal[1]*v.y + v.x*v.z;
+    dv.z = kVal[2]*v.z + v.x*v.y/3.f;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void TSUCS::Step(vec3 &v, vec3 &vp) 
+inline void TSUCS::Deriv(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*(kVal[0]*(v.y - v.x) + kVal[3]*v.x*v.z);
-    vp.y = v.y + dtStepInc*(kVal[1]*v.x + kVal[5]*v.y - v.x*v.z);
-    vp.z = v.z + dtStepInc*(kVal[2]*v.z + v.x*v.y - kVal[4]*v.x*v.x);
+    dv.x = kVal[0]*(v.y - v.x) + kVal[3]*v.x*v.z;
+    dv.y = kVal[1]*v.x + kVal[5]*v.y - v.x*v.z;
+    dv.z = kVal[2]*v.z + v.x*v.y - kVal[4]*v.x*v.x;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Aizawa::Step(vec3 &v, vec3 &vp) 
+inline void Aizawa::Deriv(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*((v.z-kVal[1])*v.x - kVal[3]*v.y);
-    vp.y = v.y + dtStepInc*((v.z-kVal[1])*v.y + kVal[3]*v.x);
+    dv.x = (v.z-kVal[1])*v.x - kVal[3]*v.y;
+    dv.y = (v.z-kVal[1])*v.y + kVal[3]*v.x;
     const float xQ = v.x*v.x;
-    vp.z = v.z + dtStepInc*(kVal[2] + kVal[0]*v.z - (v.z*v.z*v.z)/3.f - (xQ + v.y*v.y) * (1.f + kVal[4]*v.z) + kVal[5]*v.z*xQ*v.x);
+    dv.z = kVal[2] + kVal[0]*v.z - (v.z*v.z*v.z)/3.f - (xQ + v.y*v.y) * (1.f + kVal[4]*v.z) + kVal[5]*v.z*xQ*v.x;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void YuWang::Step(vec3 &v, vec3 &vp) 
+template <class MATH> ATT_FORCE_INLINE void YuWang::DerivM(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*(kVal[0]*(v.y -v.x));
-    vp.y = v.y + dtStepInc*(kVal[1]*v.x - kVal[2]*v.x*v.z);
-    vp.z = v.z + dtStepInc*(exp(v.x*v.y) - kVal[3]*v.z);
+    dv.x = kVal[0]*(v.y -v.x);
+    dv.y = kVal[1]*v.x - kVal[2]*v.x*v.z;
+    dv.z = MATH::exp(v.x*v.y) - kVal[3]*v.z;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void FourWing::Step(vec3 &v, vec3 &vp) 
+inline void FourWing::Deriv(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*(kVal[0]*v.x - kVal[1]*v.y*v.z);
-    vp.y = v.y + dtStepInc*(v.x*v.z - kVal[2]*v.y);
-    vp.z = v.z + dtStepInc*(kVal[4]*v.x - kVal[3]*v.z + v.x*v.y);
+    dv.x = kVal[0]*v.x - kVal[1]*v.y*v.z;
+    dv.y = v.x*v.z - kVal[2]*v.y;
+    dv.z = kVal[4]*v.x - kVal[3]*v.z + v.x*v.y;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void FourWing2::Step(vec3 &v, vec3 &vp) 
+inline void FourWing2::Deriv(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*(kVal[0]*v.x + kVal[1]*v.y + kVal[2]*v.y*v.z);
-    vp.y = v.y + dtStepInc*(kVal[3]*v.y - v.x*v.z);
-    vp.z = v.z + dtStepInc*(kVal[4]*v.z + kVal[5]*v.x*v.y);
+    dv.x = kVal[0]*v.x + kVal[1]*v.y + kVal[2]*v.y*v.z;
+    dv.y = kVal[3]*v.y - v.x*v.z;
+    dv.z = kVal[4]*v.z + kVal[5]*v.x*v.y;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void FourWing3::Step(vec3 &v, vec3 &vp) 
+inline void FourWing3::Deriv(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*(kVal[0]*v.x + kVal[1]*v.y + kVal[2]*v.y*v.z);
-    vp.y = v.y + dtStepInc*(kVal[3]*v.y*v.z - kVal[4]*v.x*v.z);
-    vp.z = v.z + dtStepInc*(1.f - kVal[5]*v.z - kVal[6]*v.x*v.y);
+    dv.x = kVal[0]*v.x + kVal[1]*v.y + kVal[2]*v.y*v.z;
+    dv.y = kVal[3]*v.y*v.z - kVal[4]*v.x*v.z;
+    dv.z = 1.f - kVal[5]*v.z - kVal[6]*v.x*v.y;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Thomas::Step(vec3 &v, vec3 &vp) 
+template <class MATH> ATT_FORCE_INLINE void Thomas::DerivM(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*(-kVal[0]*v.x + sinf(v.y));
-    vp.y = v.y + dtStepInc*(-kVal[1]*v.y + sinf(v.z));
-    vp.z = v.z + dtStepInc*(-kVal[2]*v.z + sinf(v.x));
+    dv.x = -kVal[0]*v.x + MATH::sin(v.y);
+    dv.y = -kVal[1]*v.y + MATH::sin(v.z);
+    dv.z = -kVal[2]*v.z + MATH::sin(v.x);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Halvorsen::Step(vec3 &v, vec3 &vp) 
+inline void Halvorsen::Deriv(const vec3 &v, vec3 &dv) 
 {
-    vp.x = v.x + dtStepInc*(-kVal[0]*v.x - 4.f*v.y - 4.f*v.z - v.y*v.y);
-    vp.y = v.y + dtStepInc*(-kVal[1]*v.y - 4.f*v.z - 4.f*v.x - v.z*v.z);
-    vp.z = v.z + dtStepInc*(-kVal[2]*v.z - 4.f*v.x - 4.f*v.y - v.x*v.x);
+    dv.x = -kVal[0]*v.x - 4.f*v.y - 4.f*v.z - v.y*v.y;
+    dv.y = -kVal[1]*v.y - 4.f*v.z - 4.f*v.x - v.z*v.z;
+    dv.z = -kVal[2]*v.z - 4.f*v.x - 4.f*v.y - v.x*v.x;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Arneodo::Step(vec3 &v, vec3 &vp) 
+inline void Arneodo::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a,b,c
-	vp.x = v.x + dtStepInc*v.y;
- 	vp.y = v.y + dtStepInc*v.z; 
- 	vp.z = v.z + dtStepInc*(-kVal[0]*v.x - kVal[1]*v.y - v.z + kVal[2]*v.x*v.x*v.x);
+	dv.x = v.y;
+ 	dv.y = v.z; 
+ 	dv.z = -kVal[0]*v.x - kVal[1]*v.y - v.z + kVal[2]*v.x*v.x*v.x;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Bouali::Step(vec3 &v, vec3 &vp) 
+inline void Bouali::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a,b,c,s,alfa,beta
-	vp.x = v.x + dtStepInc*( v.x*(kVal[0] - v.y) + kVal[4]*v.z);
- 	vp.y = v.y + dtStepInc*(-v.y*(kVal[1] - v.x*v.x));
- 	vp.z = v.z + dtStepInc*(-v.x*(kVal[2] - kVal[3]*v.z) - kVal[5]*v.z);
+	dv.x =  v.x*(kVal[0] - v.y) + kVal[4]*v.z;
+ 	dv.y = -v.y*(kVal[1] - v.x*v.x);
+ 	dv.z = -v.x*(kVal[2] - kVal[3]*v.z) - kVal[5]*v.z;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Hadley::Step(vec3 &v, vec3 &vp) 
+inline void Hadley::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a,b,f,g
-    vp.x = v.x + dtStepInc*(-v.y*v.y -v.z*v.z -kVal[0]*v.x + kVal[0]*kVal[2]);
-    vp.y = v.y + dtStepInc*(v.x*v.y - kVal[1]*v.x*v.z - v.y + kVal[3]);
-    vp.z = v.z + dtStepInc*(kVal[1]*v.x*v.y + v.x*v.z - v.z);
+    dv.x = -v.y*v.y -v.z*v.z -kVal[0]*v.x + kVal[0]*kVal[2];
+    dv.y = v.x*v.y - kVal[1]*v.x*v.z - v.y + kVal[3];
+    dv.z = kVal[1]*v.x*v.y + v.x*v.z - v.z;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void LiuChen::Step(vec3 &v, vec3 &vp) 
+inline void LiuChen::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a,b,c,d,e,f,g
-     vp.x = v.x + dtStepInc*(kVal[0]*v.y + kVal[1]*v.x + kVal[2]*v.y*v.z);
-     vp.y = v.y + dtStepInc*(kVal[3]*v.y - v.z + kVal[4]*v.x*v.z);
-     vp.z = v.z + dtStepInc*(kVal[5]*v.z + kVal[6]*v.x*v.y);
+     dv.x = kVal[0]*v.y + kVal[1]*v.x + kVal[2]*v.y*v.z;
+     dv.y = kVal[3]*v.y - v.z + kVal[4]*v.x*v.z;
+     dv.z = kVal[5]*v.z + kVal[6]*v.x*v.y;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void GenesioTesi::Step(vec3 &v, vec3 &vp) 
+inline void GenesioTesi::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a,b,c
-	vp.x = v.x + dtStepInc*v.y;
- 	vp.y = v.y + dtStepInc*v.z; 
- 	vp.z = v.z + dtStepInc*(-kVal[2]*v.x - kVal[1]*v.y - kVal[0]*v.z + v.x*v.x);
+	dv.x = v.y;
+ 	dv.y = v.z; 
+ 	dv.z = -kVal[2]*v.x - kVal[1]*v.y - kVal[0]*v.z + v.x*v.x;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void NewtonLeipnik::Step(vec3 &v, vec3 &vp) 
+inline void NewtonLeipnik::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a,b
-	vp.x = v.x + dtStepInc*(-kVal[0]*v.x + v.y + 10.0*v.y*v.z);
- 	vp.y = v.y + dtStepInc*(-v.x - 0.4*v.y + 5.0*v.x*v.z);
- 	vp.z = v.z + dtStepInc*(kVal[1]*v.z - 5.0*v.x*v.y);
+	dv.x = -kVal[0]*v.x + v.y + 10.0*v.y*v.z;
+ 	dv.y = -v.x - 0.4*v.y + 5.0*v.x*v.z;
+ 	dv.z = kVal[1]*v.z - 5.0*v.x*v.y;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void NoseHoover::Step(vec3 &v, vec3 &vp) 
+inline void NoseHoover::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a
-	vp.x = v.x + dtStepInc*v.y;
- 	vp.y = v.y + dtStepInc*(-v.x + v.y*v.z); 
- 	vp.z = v.z + dtStepInc*(kVal[0] - v.y*v.y);
+	dv.x = v.y;
+ 	dv.y = -v.x + v.y*v.z; 
+ 	dv.z = kVal[0] - v.y*v.y;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void RayleighBenard::Step(vec3 &v, vec3 &vp) 
+inline void RayleighBenard::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a, b, r
-	vp.x = v.x + dtStepInc*(-kVal[0]*(v.x - v.y));
- 	vp.y = v.y + dtStepInc*(kVal[2]*v.x - v.y - v.x*v.z); 
- 	vp.z = v.z + dtStepInc*(v.x*v.y - kVal[1]*v.z);
+	dv.x = -kVal[0]*(v.x - v.y);
+ 	dv.y = kVal[2]*v.x - v.y - v.x*v.z; 
+ 	dv.z = v.x*v.y - kVal[1]*v.z;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Sakarya::Step(vec3 &v, vec3 &vp) 
+inline void Sakarya::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a, b
-	vp.x = v.x + dtStepInc*(-v.x + v.y + v.y*v.z);
- 	vp.y = v.y + dtStepInc*(-v.x - v.y + kVal[0]*v.x*v.z); 
- 	vp.z = v.z + dtStepInc*(v.z - kVal[1]*v.x*v.y);
+	dv.x = -v.x + v.y + v.y*v.z;
+ 	dv.y = -v.x - v.y + kVal[0]*v.x*v.z; 
+ 	dv.z = v.z - kVal[1]*v.x*v.y;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Robinson::Step(vec3 &v, vec3 &vp) 
+inline void Robinson::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a, b, c, d, v
     const float x2 = v.x*v.x;
-	vp.x = v.x + dtStepInc*v.y;
- 	vp.y = v.y + dtStepInc*(v.x - 2*x2*v.x - kVal[0]*v.y + kVal[1]*x2*v.y - kVal[4]*v.y*v.z); 
- 	vp.z = v.z + dtStepInc*(-kVal[2]*v.z + kVal[3]*x2);
+	dv.x = v.y;
+ 	dv.y = v.x - 2*x2*v.x - kVal[0]*v.y + kVal[1]*x2*v.y - kVal[4]*v.y*v.z; 
+ 	dv.z = -kVal[2]*v.z + kVal[3]*x2;
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rossler::Step(vec3 &v, vec3 &vp) 
+inline void Rossler::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a, b, c
-	vp.x = v.x + dtStepInc*(-v.y - v.z);
- 	vp.y = v.y + dtStepInc*(v.x + kVal[0]*v.y); 
- 	vp.z = v.z + dtStepInc*(kVal[1] + v.z*(v.x - kVal[2]));
+	dv.x = -v.y - v.z;
+ 	dv.y = v.x + kVal[0]*v.y; 
+ 	dv.z = kVal[1] + v.z*(v.x - kVal[2]);
 }
 ////////////////////////////////////////////////////////////////////////////
-inline void Rucklidge::Step(vec3 &v, vec3 &vp) 
+inline void Rucklidge::Deriv(const vec3 &v, vec3 &dv) 
 { // kVal[] -> a, k
-	vp.x = v.x + dtStepInc*(-kVal[1]*v.x + kVal[0]*v.y - v.y*v.z);
- 	vp.y = v.y + dtStepInc*v.x; 
- 	vp.z = v.z + dtStepInc*(-v.z + v.y*v.y);
+	dv.x = -kVal[1]*v.x + kVal[0]*v.y - v.y*v.z;
+ 	dv.y = v.x; 
+ 	dv.z = -v.z + v.y*v.y;
 }
 
+//  Magnetic kernels
+//  magnets grouped by permutation class (i % classes) in SoA arrays, each
+//  class padded to MAGNETIC_LANES w/ null magnets (k = 0): the loop over
+//  the magnets of a class has no tail and is vectorized (needs also
+//  -fno-trapping-math to if-convert the d > eps mask), the permutation
+//  (linear) is applied only to the sum of each class
 ////////////////////////////////////////////////////////////////////////////
-inline void Magnetic::Step(vec3 &v, vec3 &vp) 
-{
-    vp=vec3(0.f);
-
-    int i = 0;
-    for(auto itPt = vVal.begin(), itK = kVal.begin(); !newItemsEnd && itPt!=vVal.end();) {
-        const vec3 vo = *itPt++ - v; //vo.z=0.0;                
-        const float dotProd = dot(vo,vo);
-        if(dotProd > FLT_EPSILON) vp+=(this->*increment)(vec3(*itK++ * (vo / dotProd)),i++);
+#define MAGNETIC_LANES 8
+
+struct magneticSoA {
+    vector<float> x, y, z, kx, ky, kz;
+    int start[magneticFullPermutated::classes+1];
+
+    template <class PERM> void build(const vector<vec3> &vVal, const vector<vec3> &kVal, int nMagnets) {
+        int n = 0;
+        for(int c=0; c<PERM::classes; c++) {
+            start[c] = n;
+            const int sz = c<nMagnets ? (nMagnets-c-1)/PERM::classes + 1 : 0;
+            n += (sz + MAGNETIC_LANES-1) & ~(MAGNETIC_LANES-1);
+        }
+        start[PERM::classes] = n;
+
+        x.assign(n, 0.f); y.assign(n, 0.f); z.assign(n, 0.f);
+        kx.assign(n, 0.f); ky.assign(n, 0.f); kz.assign(n, 0.f);
+        for(int c=0; c<PERM::classes; c++)
+            for(int i=c, j=start[c]; i<nMagnets; i+=PERM::classes, j++) {
+                x[j] = vVal[i].x; y[j] = vVal[i].y; z[j] = vVal[i].z;
+                kx[j] = kVal[i].x; ky[j] = kVal[i].y; kz[j] = kVal[i].z;
+            }
     }
-}
+};
+
+template <class PERM> struct magneticStep {
+    const magneticSoA *soa;
+
+    ATT_FORCE_INLINE void operator()(vec3 &v, vec3 &vp) const {
+        const float * __restrict x = soa->x.data();
+        const float * __restrict y = soa->y.data();
+        const float * __restrict z = soa->z.data();
+        const float * __restrict kx = soa->kx.data();
+        const float * __restrict ky = soa->ky.data();
+        const float * __restrict kz = soa->kz.data();
+        const float vx = v.x, vy = v.y, vz = v.z;
+
+        vp = vec3(0.f);
+        for(int c=0; c<PERM::classes; c++) {
+            // per lane accumulators: float sum reduction is not vectorized w/o fast-math
+            float sx[MAGNETIC_LANES] = {}, sy[MAGNETIC_LANES] = {}, sz[MAGNETIC_LANES] = {};
+            for(int m=soa->start[c]; m<soa->start[c+1]; m+=MAGNETIC_LANES) {
+                for(int j=0; j<MAGNETIC_LANES; j++) {
+                    const float ox = x[m+j]-vx, oy = y[m+j]-vy, oz = z[m+j]-vz;
+                    const float d = ox*ox + oy*oy + oz*oz;
+                    // branch-free: masked 1/max(d,eps) (cmpps/maxps/divps)
+                    const float s = float(d > FLT_EPSILON) / std::max(d, FLT_EPSILON);
+                    sx[j] += kx[m+j]*ox*s; sy[j] += ky[m+j]*oy*s; sz[j] += kz[m+j]*oz*s;
+                }
+            }
+            vec3 sum(0.f);
+            for(int j=0; j<MAGNETIC_LANES; j++) sum += vec3(sx[j], sy[j], sz[j]);
+            vp += PERM::permute(sum, c);
+        }
+    }
+};
 
-inline const vec3 Magnetic::straight(const vec3 &vx, int i) 
+uint64_t Magnetic::newGeneration()
 {
-
-    return vx;
+    static std::atomic<uint64_t> generations { 0 };
+    return ++generations;
 }
 
-inline const vec3 Magnetic::rightShift(const vec3 &vx, int i) 
+//  SoA of each thread, shared by single step and batches: rebuilt only when
+//  values generation (or newItemsEnd, magnets changing) is not the built one
+template <class PERM> inline const magneticSoA *magneticBuild(const vector<vec3> &vVal, const vector<vec3> &kVal, bool newItemsEnd, uint64_t generation)
 {
-    switch(i%3) {
-        case 0 :  return vx;
-        case 1 :  return vec3(vx.z,vx.x,vx.y);
-        case 2 :  return vec3(vx.y,vx.z,vx.x); 
+    static thread_local magneticSoA soa;
+    static thread_local uint64_t built = 0;
+    const uint64_t key = generation*2 + newItemsEnd;
+    if(key != built) {
+        soa.build<PERM>(vVal, kVal, newItemsEnd ? 0 : int(std::min(vVal.size(), kVal.size())));
+        built = key;
     }
-
-    return vx;
+    return &soa;
 }
 
-inline const vec3 Magnetic::leftShift(const vec3 &vx, int i) 
+template <class PERM> void magneticKernel<PERM>::Step(vec3 &v, vec3 &vp) 
 {
-    switch(i%3) {
-        case 0 :  return vx;
-        case 1 :  return vec3(vx.y,vx.z,vx.x);
-        case 2 :  return vec3(vx.z,vx.x,vx.y); 
-    }
-    return vx;
+    magneticStep<PERM> { magneticBuild<PERM>(vVal, kVal, newItemsEnd, getValuesGeneration()) } (v, vp);
 }
-inline const vec3 Magnetic::fullPermutated(const vec3 &vx, int i) 
+
+template <class PERM> void magneticKernel<PERM>::Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements) 
 {
-    switch(i%6) {
-        case 0 :  return vx;
-        case 1 :  return vec3(vx.y,vx.z,vx.x);
-        case 2 :  return vec3(vx.z,vx.x,vx.y); 
-        case 3 :  return vec3(vx.x,vx.z,vx.y);
-        case 4 :  return vec3(vx.z,vx.y,vx.x);
-        case 5 :  return vec3(vx.y,vx.x,vx.z); 
-    }
-    return vx;
+    stepPoints(magneticStep<PERM> { magneticBuild<PERM>(vVal, kVal, newItemsEnd, getValuesGeneration()) }, ptr, v, vp, numElements);
 }
 
-inline const vec3 Magnetic::tryed(const vec3 &vx, int i) 
+template <class PERM> void magneticKernel<PERM>::Step(float *&ptr, multiOrbitClass &orbits, uint numElements) 
 {
-    switch(i%3) {
-        case 0 :  return vx;
-        case 1 :  return vec3(vx.x,sinf(vx.y/M_PI),cosf(vx.z/M_PI));
-        case 2 :  return vec3(vx.x,cosf(vx.y/M_PI),sinf(vx.z/M_PI)); 
-    }
-    return vx;
+    stepOrbits(magneticStep<PERM> { magneticBuild<PERM>(vVal, kVal, newItemsEnd, getValuesGeneration()) }, ptr, orbits, numElements);
 }
 
-//  Attractors Thread helper class
+//  Emission statistics
 ////////////////////////////////////////////////////////////////////////////
-void threadStepClass::newThread()
+void emissionStats::accumulate(const float *pts, uint n)
 {
-#ifdef USE_THREAD_TO_FILL
-    attractorsList.queryStartThread();  //endlessLoop = true
-    if(attractorLoop == nullptr) {
-        attractorLoop = new thread(&AttractorsClass::endlessStep, &attractorsList, emitter);
-        //attractorLoop->detach();
+    // 4 interleaved histograms: consecutive points are often in same bin
+    uint32_t h[4][STATS_HIST_BINS] = {};
+    auto histBin = [] (float w) {
+        // log2 bin from float bits: exponent + first 2 bits of mantissa (STATS_HIST_SUBBINS = 4)
+        const int bin = int((floatBitsToUint(w) & 0x7fffffff) >> 21) - ((127 + STATS_HIST_MINEXP) << 2);
+        return bin<0 ? 0 : (bin>=STATS_HIST_BINS ? STATS_HIST_BINS-1 : bin);
+    };
+
+    count += n;
+    const vec4 *p = (const vec4 *) pts;
+    for(uint first=0; first<n; first+=STATS_BLOCK) {
+        const uint end = std::min(n, first+STATS_BLOCK);
+
+        // branchless pass: non finite points (diverging orbits) give non finite sum
+        vec4 bMin(FLT_MAX), bMax(-FLT_MAX), bSum(0.f);
+        uint nSamples = 0;
+        for(uint i=first; i<end; i+=STATS_STRIDE, nSamples++) { bMin = min(bMin, p[i]); bMax = max(bMax, p[i]); bSum += p[i]; }
+
+        if(std::isfinite(bSum.x) && std::isfinite(bSum.y) && std::isfinite(bSum.z) && std::isfinite(bSum.w)) {
+            for(uint i=first, k=0; i<end; i+=STATS_STRIDE, k++) h[k&3][histBin(p[i].w)]++;
+        } else {
+            bMin = vec4(FLT_MAX); bMax = vec4(-FLT_MAX); bSum = vec4(0.f);
+            nSamples = 0;
+            for(uint i=first; i<end; i+=STATS_STRIDE) {
+                const vec4 &v = p[i];
+                if(!(std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z) && std::isfinite(v.w))) continue;
+                bMin = min(bMin, v); bMax = max(bMax, v); bSum += v;
+                h[0][histBin(v.w)]++;
+                nSamples++;
+            }
+        }
+        if(!nSamples) continue;
+        vMin = min(vMin, vec3(bMin)); vMax = max(vMax, vec3(bMax));
+        speedMax = std::max(speedMax, bMax.w);
+        // block sum in float, total in double
+        sum += dvec3(vec3(bSum));
+        samples += nSamples;
     }
-#endif
+
+    for(int i=0; i<STATS_HIST_BINS; i++) hist[i] += h[0][i] + h[1][i] + h[2][i] + h[3][i];
 }
-void threadStepClass::startThread(bool stratOn)
+
+void emissionStats::merge(const emissionStats &s)
 {
-    emitter->setEmitter(stratOn);
+    if(s.isEmpty()) return;
+    vMin = min(vMin, s.vMin); vMax = max(vMax, s.vMax);
+    sum += s.sum;
+    speedMax = std::max(speedMax, s.speedMax);
+    count += s.count;
+    samples += s.samples;
+    for(int i=0; i<STATS_HIST_BINS; i++) hist[i] += s.hist[i];
 }
 
-void threadStepClass::deleteThread()
+float emissionStats::getSpeedPercentile(float p) const
 {
-#ifdef USE_THREAD_TO_FILL
-    if(getThread() && (getThread()->get_id() != std::thread::id())) {
-        attractorsList.queryStopThread();
-        stopThread();
-        getThread()->join();
-        delete getThread();
-        //attractorLoop = nullptr;
+    if(!samples) return 0.f;
+    const uint64_t target = uint64_t(double(p) * double(samples));
+    uint64_t acc = 0;
+    for(int i=0; i<STATS_HIST_BINS; i++) {
+        acc += hist[i];
+        if(acc > target) return std::min(getBinSpeed(i+1), speedMax);
     }
-#endif
+    return speedMax;
 }
 
-void threadStepClass::stopThread() {
-#ifdef USE_THREAD_TO_FILL
-    emitter->setEmitterOff();
-    while(emitter->isLoopRunning())
-        std::this_thread::sleep_for(200ms);
-#endif
-}
+//  Emission health
+////////////////////////////////////////////////////////////////////////////
+int checkEmissionHealth(const float *pts, uint n)
+{
+    const vec4 *p = (const vec4 *) pts;
+    const uint tail = n>HEALTH_TAIL ? n-HEALTH_TAIL : 0;
 
-void threadStepClass::notify() {
-#ifdef USE_THREAD_TO_FILL
-    attractorsList.stepCondVar.notify_one();
-#endif
-}
+    // v*0 is NaN for NaN and inf: any non finite value makes nanAcc NaN
+    vec4 nanAcc(0.f), maxAbs(0.f);
+    for(uint i=0; i<tail; i+=HEALTH_STRIDE) { nanAcc += p[i]*0.f; maxAbs = max(maxAbs, abs(p[i])); }
 
-void threadStepClass::restartEmitter() { 
-    emitter->resetVBOindexes(); 
-    attractorsList.get()->resetEmittedParticles();
-}
-   
-//  Attractor Class container
-////////////////////////////////////////////////////////////////////////////
-void AttractorsClass::newSelection(int i) {
-    if(i==getSelection()) return;
-    getThreadStep()->stopThread();
-    selection(i);
-    theApp->getMainDlg().getParticlesDlgClass().resetTreeParticlesFlags();
-    theApp->loadAttractor(getFileName().c_str());
-    getThreadStep()->restartEmitter();
-    get()->initStep();
-    getThreadStep()->startThread();
+    vec4 tailAbs(0.f);
+    for(uint i=tail; i<n; i++) { nanAcc += p[i]*0.f; tailAbs = max(tailAbs, abs(p[i])); }
+    maxAbs = max(maxAbs, tailAbs);
 
-}
-void AttractorsClass::selection(int i) {
-    selected = i; 
-    theWnd->getParticlesSystem()->getTMat()->setView(get()->getPOV(),get()->getTGT());
-    //restart();    
+    if(!(nanAcc.x + nanAcc.y + nanAcc.z + nanAcc.w == 0.f)) return emitDiverged;
+    if(std::max(maxAbs.x, std::max(maxAbs.y, maxAbs.z)) > HEALTH_MAX_COORD) return emitDiverged;
+    if(n && tailAbs.w <= HEALTH_MIN_SPEED * (1.f + std::max(tailAbs.x, std::max(tailAbs.y, tailAbs.z)))) return emitFixedPoint;
+    return emitHealthy;
 }
 
-
-void AttractorsClass::newStepThread(emitterBaseClass *e) 
+//  Vertex packing
+////////////////////////////////////////////////////////////////////////////
+void vertexPacking::fit(AttractorBase *att, vec3 v)
 {
-    threadStep = new threadStepClass(e);
+    qMin = vec4(0.f); qScale = vec4(1.f);
+    if(format != vtxFmtUnorm16) return;
+
+    vector<float> pts(VERTEX_FIT_POINTS*4);
+    vec3 vp = v;
+    float *ptr = pts.data();
+    att->Step(ptr, v, vp, VERTEX_FIT_POINTS);
+
+    vec4 vMin(FLT_MAX), vMax(-FLT_MAX);
+    for(int i=VERTEX_FIT_SKIP; i<VERTEX_FIT_POINTS; i++) {
+        const vec4 p = glm::make_vec4(pts.data() + i*4);
+        if(any(isnan(p)) || any(isinf(p))) continue;
+        vMin = min(vMin, p); vMax = max(vMax, p);
+    }
+    if(vMin.x > vMax.x) { qMin = vec4(vec3(-1.f), 0.f); qScale = vec4(vec3(2.f), 1.f); return; }
+
+    // margin for the points not yet seen, out of box points are clamped
+    const vec3 margin = vec3(vMax - vMin) * .125f;
+    setBox(vec4(vec3(vMin) - margin, 0.f), vec4(vec3(vMax) + margin, vMax.w*1.25f));
 }
 
-void AttractorsClass::deleteStepThread() 
+void vertexPacking::setBox(const vec4 &vMin, const vec4 &vMax)
 {
-    delete threadStep;
-    threadStep = nullptr;
+    qMin = vec4(0.f); qScale = vec4(1.f);
+    if(format != vtxFmtUnorm16) return;
+    qMin   = vec4(vec3(vMin), 0.f);
+    qScale = vec4(vec3(vMax - vMin), vMax.w) + FLT_EPSILON;
 }
 
-void AttractorsClass::generateNewRandom() {
-    getThreadStep()->stopThread();
+void vertexPacking::extend(const vec4 &vMin, const vec4 &vMax)
+{
+    if(format != vtxFmtUnorm16) return;
+    if(any(isnan(vMin)) || any(isinf(vMin)) || any(isnan(vMax)) || any(isinf(vMax))) return;
 
-    get()->newRandomValues(); 
+    const vec4 bMin = min(qMin, vMin), bMax = max(qMin + qScale, vMax);
+    const vec3 margin = vec3(bMax - bMin) * .125f;
+    setBox(vec4(vec3(bMin) - margin, 0.f), vec4(vec3(bMax) + margin, bMax.w*1.25f));
+}
 
-    getThreadStep()->restartEmitter();
-    get()->initStep();
+bool vertexPacking::pack(const float *src, void *dst, uint n, vec4 *bMin, vec4 *bMax) const
+{
+    uint64_t *d = (uint64_t *) dst;
+    if(format == vtxFmtHalf) {
+        for(uint i=0; i<n; i++, src+=4) d[i] = glm::packHalf4x16(glm::make_vec4(src));
+        return true;
+    }
 
-    get()->searchAttractor();
+    // range of normalized points, out of [0,1] are clamped
+    const vec4 invScale = 1.f / qScale;
+    vec4 qLo(0.f), qHi(1.f);
+    for(uint i=0; i<n; i++, src+=4) {
+        const vec4 q = (glm::make_vec4(src) - qMin) * invScale;
+        qLo = min(qLo, q); qHi = max(qHi, q);
+        d[i] = glm::packUnorm4x16(q);
+    }
+    if(all(greaterThanEqual(qLo, vec4(0.f))) && all(lessThanEqual(qHi, vec4(1.f)))) return true;
 
-    getThreadStep()->startThread();
+    if(bMin) *bMin = qMin + qLo * qScale;
+    if(bMax) *bMax = qMin + qHi * qScale;
+    return false;
 }
 
-
-void AttractorsClass::restart()
+void vertexPacking::unpack(const void *src, float *dst, uint n) const
 {
-    getThreadStep()->stopThread();
-    getThreadStep()->restartEmitter();
-    get()->initStep();
-    getThreadStep()->startThread();
-
-//    if(!theWnd->getParticlesSystem()->getEmitter()->isEmitterOn())
-        //theWnd->getParticlesSystem()->getEmitter()->setEmitterOn();
-
+    if(format == vtxFmtFloat) { memcpy(dst, src, size_t(n) * 4*sizeof(float)); return; }
+
+    const uint64_t *s = (const uint64_t *) src;
+    vec4 *d = (vec4 *) dst;
+    if(format == vtxFmtHalf) {
+        for(uint i=0; i<n; i++) d[i] = glm::unpackHalf4x16(s[i]);
+    } else {
+        for(uint i=0; i<n; i++) d[i] = qMin + glm::unpackUnorm4x16(s[i]) * qScale;
+    }
 }
+
+//  attractorMathKernel/attractorDtKernel instances: vtables of these attractors are emitted
+//  w/ their startData (attractorsStartVals.cpp)
+////////////////////////////////////////////////////////////////////////////
+template class attractorMathKernel<PolynomialPow , PolynomialBase>;
+template class attractorMathKernel<PolynomialSin , PolynomialBase>;
+template class attractorMathKernel<Rampe01       , RampeBase>;
+template class attractorMathKernel<Rampe02       , RampeBase>;
+template class attractorMathKernel<Rampe03       , RampeBase>;
+template class attractorMathKernel<Rampe03A      , RampeBase>;
+template class attractorMathKernel<Rampe04       , RampeBase>;
+template class attractorMathKernel<Rampe05       , RampeBase>;
+template class attractorMathKernel<Rampe06       , RampeBase>;
+template class attractorMathKernel<Rampe07       , RampeBase>;
+template class attractorMathKernel<Rampe08       , RampeBase>;
+template class attractorMathKernel<Rampe09       , RampeBase>;
+template class attractorMathKernel<Rampe10       , RampeBase>;
+template class attractorMathKernel<KingsDream    , attractorScalarK>;
+template class attractorMathKernel<Pickover      , attractorScalarK>;
+template class attractorMathKernel<SinCos        , attractorScalarK>;
+
+template class attractorDtKernel<Lorenz         >;
+template class attractorDtKernel<ChenLee        >;
+template class attractorDtKernel<TSUCS          >;
+template class attractorDtKernel<Aizawa         >;
+template class attractorDtKernel<YuWang   , true>;
+template class attractorDtKernel<FourWing       >;
+template class attractorDtKernel<FourWing2      >;
+template class attractorDtKernel<FourWing3      >;
+template class attractorDtKernel<Thomas   , true>;
+template class attractorDtKernel<Halvorsen      >;
+template class attractorDtKernel<Arneodo        >;
+template class attractorDtKernel<Bouali         >;
+template class attractorDtKernel<Hadley         >;
+template class attractorDtKernel<LiuChen        >;
+template class attractorDtKernel<GenesioTesi    >;
+template class attractorDtKernel<NewtonLeipnik  >;
+template class attractorDtKernel<NoseHoover     >;
+template class attractorDtKernel<RayleighBenard >;
+template class attractorDtKernel<Sakarya        >;
+template class attractorDtKernel<Robinson       >;
+template class attractorDtKernel<Rossler        >;
+template class attractorDtKernel<Rucklidge      >;
+
+template class magneticKernel<magneticLeftShift     >;
+template class magneticKernel<magneticRightShift    >;
+template class magneticKernel<magneticFullPermutated>;
@@ -48,6 +48,9 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cfloat>
 //#include <omp.h>
 
 //#include "nv/nvMath.h"
@@ -57,9 +60,10 @@
 
 #include "libs/configuru/configuru.hpp"
 
-#include "libs/Random/random.hpp"
 
 #include "attractorsStartVals.h"
+#include "attractorsMath.h"
+#include "attractorsRandom.h"
 
 
 //void resetVBOindexes();
@@ -68,16 +72,94 @@ using namespace glm;
 using namespace std;
 using namespace configuru;
 
-using Random = effolkronium::random_static;
 
-#define BUFFER_DIM 100
+// last points of attractor (stepQueue): power of 2
+#define BUFFER_DIM 128
+// points generated by each batch Step call in the fill thread
+#define STEP_BATCH_SIZE 4096
 
 //#define RANDOM(MIN, MAX) ((MIN)+((float)rand()/(float)RAND_MAX)*((MAX)-(MIN)))
-#define RANDOM(MIN, MAX) (Random::get<float>(float(MIN),float(MAX)))
+#define RANDOM(MIN, MAX) (attRng().get(float(MIN),float(MAX)))
 
 class attractorDlgClass;
+
+//  Fixed size ring buffer: push_front overwrites oldest element, [0] is
+//  last inserted (same indexes of a deque w/ push_front + pop_back)
+////////////////////////////////////////////////////////////////////////////
+template <class T, int N> class ringBuffer
+{
+public:
+    static_assert((N & (N-1)) == 0, "ringBuffer: size must be a power of 2");
+
+    ringBuffer() { for(auto &e : buf) e = T(0); }
+
+    void push_front(const T &v) { head = (head-1) & (N-1); buf[head] = v; }
+
+    T& front() { return buf[head]; }
+    T& operator[](int i) { return buf[(head+i) & (N-1)]; }
+
+    int size() { return N; }
+
+private:
+    T buf[N];
+    int head = 0;
+};
+//  Emission statistics: bounds, centroid and speed (w) histogram of the
+//  emitted points, accumulated while stepping on one point every STATS_STRIDE
+//  (consecutive points are near: bounds error is about a few steps), non
+//  finite points skipped
+//  Histogram is log2: STATS_HIST_SUBBINS bins per octave from 2^STATS_HIST_MINEXP
+////////////////////////////////////////////////////////////////////////////
+#define STATS_HIST_SUBBINS 4 // 2 mantissa bits
+#define STATS_HIST_MINEXP (-20)
+#define STATS_HIST_BINS (32*STATS_HIST_SUBBINS)
+#define STATS_STRIDE 4
+// points summed in float before adding to double total
+#define STATS_BLOCK 1024
+
+struct emissionStats
+{
+    vec3 vMin = vec3(FLT_MAX), vMax = vec3(-FLT_MAX);
+    dvec3 sum = dvec3(0.0);
+    float speedMax = 0.f;
+    uint64_t count = 0;     // points seen
+    uint64_t samples = 0;   // finite points sampled: centroid and histogram
+    uint64_t hist[STATS_HIST_BINS] = {};
+
+    void reset() { *this = emissionStats(); }
+    bool isEmpty() const { return !count; }
+
+    //n points (4 floats: xyz + speed)
+    void accumulate(const float *pts, uint n);
+    void merge(const emissionStats &s);
+
+    vec3 getCentroid() const { return samples ? vec3(sum / double(samples)) : vec3(0.f); }
+    //speed below which is fraction p (0..1) of the samples (upper edge of bin)
+    float getSpeedPercentile(float p) const;
+    static float getBinSpeed(int bin) { return exp2(float(STATS_HIST_MINEXP) + float(bin)/STATS_HIST_SUBBINS); }
+};
+
+//  Emission health: dead orbits (NaN/inf, out of HEALTH_MAX_COORD, fixed
+//  point) in an emitted batch, checked on one point every HEALTH_STRIDE
+//  (prime: all multi-orbit lanes) and on all last HEALTH_TAIL points (dead
+//  states are absorbing)
+////////////////////////////////////////////////////////////////////////////
+enum emissionHealth { emitHealthy, emitDiverged, emitFixedPoint };
+
+#define HEALTH_STRIDE 17
+#define HEALTH_TAIL 64
+#define HEALTH_MAX_COORD 1.e5f
+// fixed point: speed of tail points under HEALTH_MIN_SPEED * (1 + |coord|)
+#define HEALTH_MIN_SPEED 1.e-6f
+// reseeds near last good point in an emission, then emission is paused
+#define HEALTH_RESEEDS_MAX 8
+
+//n points (4 floats: xyz + speed): emissionHealth value
+int checkEmissionHealth(const float *pts, uint n);
+
 class AttractorsClass;
 class emitterBaseClass;
+class multiOrbitClass;
 
 //  Attractor base class
 ////////////////////////////////////////////////////////////////////////////
@@ -102,8 +184,6 @@ public:
     void Insert(const vec3 &vect)
     {
         stepQueue.push_front(vect);
-        //deque <vec3>::size_type sz = stepQueue.size();
-        stepQueue.pop_back();
     }
 
     virtual void resetQueue();
@@ -113,6 +193,18 @@ public:
 
     virtual void searchAttractor() {};
     void searchLyapunov();
+    //Lyapunov exponent from current point: see lyapunovMapClass (chaosCore.h)
+    bool lyapunovDivergent(int nSteps);
+    float lyapunovExponent(vec3 ve, float d0, int nSteps, bool *chaotic = nullptr);
+    //search interrupted when *cancel is true (nullptr: never)
+    void setSearchCancel(const std::atomic<bool> *cancel) { searchCancel = cancel; }
+    //last searchAttractor result: false if cancelled or no attractor found
+    bool isSearchFound() { return searchFound; }
+
+    //newRandomValues from seed s: same seed and limits, same values
+    void randomValues(uint32_t s) { attRng().seed(seed = s); newRandomValues(); }
+    //seed of random values ("seed" in .sca files): 0 if unknown
+    uint32_t getSeed() { return seed; }
 
 
     virtual void saveVals(const char *name) {}
@@ -124,9 +216,6 @@ public:
     virtual void saveAdditionalData(Config &cfg) {}
     virtual void loadAdditionalData(Config &cfg) {}
 
-    virtual int additionalDataDlg();
-    virtual void additionalDataCtrls() {}
-
     virtual void saveKVals(Config &cfg) = 0;
     virtual void loadKVals(Config &cfg) = 0;
 
@@ -142,6 +231,10 @@ public:
 
     //thread Step with shared GPU memory
     void Step(float *&ptr, vec3 &v, vec3 &vp);
+    //batch Step with shared GPU memory: numElements points from v
+    virtual void Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements);
+    //multi-orbit batch Step: numElements points interleaved from orbits
+    virtual void Step(float *&ptr, multiOrbitClass &orbits, uint numElements);
     //single step
     virtual void Step();
     //buffered Step
@@ -178,23 +271,30 @@ public:
 
     void setBufferRendered() {  bufferRendered = true; }
 
-    int getEmittedParticles() { return emittedPoints; }
-    uint &getRefEmittedParticles() { return emittedPoints; }
-    void resetEmittedParticles() { emittedPoints = 0; }
-    void incEmittedParticles() { emittedPoints++; }
+    void resetStats() { stats.reset(); }
 
     bool dlgAdditionalDataVisible() { return bDlgAdditionalDataVisible; }
     void dlgAdditionalDataVisible(bool b) { bDlgAdditionalDataVisible=b; }
 
     bool dtType() { return isDTtype; }
 
+    //precision of sin/cos/... in Step: attMathExact, attMathFast, attMathFastest
+    bool mathType() { return isMathType; }
+    int getMathPrecision() { return mathPrecision; }
+    void setMathPrecision(int p) { mathPrecision = p; }
+
+    uint getStepGeneration() { return stepGeneration; }
+
+    //statistics of points emitted since last resetStats (render thread)
+    emissionStats &getStats() { return stats; }
+
     vector<vec3> vVal;
 protected:
 
     //innerThreadStepPtrFn innerThreadStepFn;
     stepPtrFn stepFn;
 
-    deque<vec3> stepQueue;
+    ringBuffer<vec3, BUFFER_DIM> stepQueue;
 
     // limit random generators
     float kMax, kMin, vMax, vMin;
@@ -209,14 +309,62 @@ protected:
     friend class attractorDlgClass;
     friend class AttractorsClass;
     bool bufferRendered = false;
-    uint emittedPoints = 0;
+    emissionStats stats;
 
     bool flagFileData = false;
     bool isDTtype = false;
+    bool isMathType = false;
+    int mathPrecision = attMathExact;
+
+    // incremented on every resetQueue: tells to multi-orbit to reseed
+    uint stepGeneration = 0;
+
+    const std::atomic<bool> *searchCancel = nullptr;
+    bool searchFound = true;
+    uint32_t seed = 0;
 private:
 
 };
 
+//  Multi-orbit: K independent orbits from seeds spread near start point,
+//  stepped together in SoA lanes and interleaved in vertex buffer
+////////////////////////////////////////////////////////////////////////////
+#define MULTI_ORBIT_MAX 16
+#define MULTI_ORBIT_SPREAD .001f
+
+class multiOrbitClass
+{
+public:
+    void setOrbits(int n) { 
+        nOrbits = n<1 ? 1 : (n>MULTI_ORBIT_MAX ? MULTI_ORBIT_MAX : n); 
+        owner = nullptr;
+    }
+    int getOrbits() { return nOrbits; }
+    bool isMultiOrbit() { return nOrbits>1; }
+
+    //new seeds (near v0) after attractor selection or restart
+    void checkSeeds(AttractorBase *att, const vec3 &v0, bool jitterFirst = false) {
+        if(att!=owner || att->getStepGeneration()!=generation) seed(att, v0, jitterFirst);
+    }
+    void checkSeeds(AttractorBase *att) { checkSeeds(att, att->getCurrent()); }
+    void seed(AttractorBase *att, const vec3 &v0, bool jitterFirst);
+
+    vec3 getAt(int i) { return vec3(x[i], y[i], z[i]); }
+    void setAt(int i, const vec3 &v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; }
+
+    // no more than heap alignment: workers orbits are allocated in a vector
+    alignas(16) float x[MULTI_ORBIT_MAX];
+    alignas(16) float y[MULTI_ORBIT_MAX];
+    alignas(16) float z[MULTI_ORBIT_MAX];
+
+private:
+    int nOrbits = 1;
+    AttractorBase *owner = nullptr;
+    uint generation = 0;
+
+    attRandom rnd;
+};
+
 //  Attractors class with scalar K coeff
 ////////////////////////////////////////////////////////////////////////////
 class attractorScalarK : public AttractorBase
@@ -232,7 +380,7 @@ public:
 
     virtual void newRandomValues() 
     {
-            for (int i=0; i<kVal.size(); i++) kVal[i] = RANDOM(kMin,kMax);
+            attRng().fill(kVal.data(), kVal.size(), kMin, kMax);
             vVal[0] = vec3(RANDOM(vMin,vMax),RANDOM(vMin,vMax),RANDOM(vMin,vMax));
     }
 
@@ -248,8 +396,9 @@ public:
 
     float getValue(int i, int type)                  { return type ? kVal[i] : vVal[0][i]; }
     float getValue(int x, int y, int type)           { return type ? kVal[x] : vVal[x][y]; }
-    void setValue(int i, int type, float val)        { type ? kVal[i]=val : vVal[0][i]=val; }
-    void setValue(int x, int y, int type, float val) { type ? kVal[x]=val : vVal[x][y]=val; }
+    //edited values: no more from a seed
+    void setValue(int i, int type, float val)        { type ? kVal[i]=val : vVal[0][i]=val; seed = 0; }
+    void setValue(int x, int y, int type, float val) { type ? kVal[x]=val : vVal[x][y]=val; seed = 0; }
 
     int getNumElements(int type) {  return (type) ? kVal.size () : vVal.size(); } //return # rows
 
@@ -262,8 +411,23 @@ protected:
 
 };
 
+//  integration methods of d(x,y,z)/dt attractors
+enum dtIntegrators { dtIntEuler, dtIntRK4, dtIntRK45, dtIntLeapfrog };
+//  arc-length emission: max steps for each point (stationary points)
+#define DT_ARC_MAX_SUBSTEPS 4096
+
 class attractorDtType : public attractorScalarK
 {
+public:
+    int getIntegrator() { return integrator; }
+    void setIntegrator(int i) { integrator = i; }
+    float getDtStepInc() { return dtStepInc; }
+    void setDtStepInc(float f) { dtStepInc = f; }
+    float getTolerance() { return tolerance; }
+    void setTolerance(float f) { tolerance = f; }
+    float getArcLength() { return arcLength; }
+    void setArcLength(float f) { arcLength = f; }
+
 protected:
 
     attractorDtType() {
@@ -271,12 +435,19 @@ protected:
         isDTtype = true;
     }
 
-    virtual void additionalDataCtrls();
-
     virtual void saveAdditionalData(Config &cfg);
     virtual void loadAdditionalData(Config &cfg);
     // dTime step 
     float dtStepInc = 0.001f;
+    // Euler (default, as old files), RK4, RK45 w/ step control, Leapfrog
+    int integrator = dtIntEuler;
+    // RK45: max local error for each dtStepInc, relative to |v|+1
+    float tolerance = 1.e-5f;
+    // > 0: a point is emitted only when trajectory has advanced arcLength
+    // (uniform density), 0: a point for each dtStepInc
+    float arcLength = 0.f;
+
+    friend class attractorDlgClass;
 
 
 };
@@ -297,7 +468,7 @@ public:
     }
     virtual void newRandomValues() 
     {
-            for (auto &i : kVal) i = vec3(RANDOM(kMin,kMax),RANDOM(kMin,kMax),RANDOM(kMin,kMax));
+            attRng().fill((float *) kVal.data(), kVal.size()*3, kMin, kMax);
             vVal[0] = vec3(RANDOM(vMin,vMax),RANDOM(vMin,vMax),RANDOM(vMin,vMax));
     }
 
@@ -310,13 +481,16 @@ public:
 
     virtual float getValue(int i, int type) { return type ? kVal[0][i] : vVal[0][i]; }
     virtual float getValue(int row, int col, int type) { return type ? kVal[row][col] : vVal[row][col]; }
+    //edited values: no more from a seed
     virtual void setValue(int i, int type, float val) { 
         if (type) kVal[0][i]=val;
         else      vVal[0][i]=val;
+        seed = 0;
     }
     virtual void setValue(int row, int col, int type, float val) { 
         if (type) kVal[row][col]=val;
         else      vVal[row][col]=val;
+        seed = 0;
     }
 
     int getNumElements(int type) {  return (type) ? kVal.size () : vVal.size(); } //return # rows
@@ -332,6 +506,45 @@ protected:
 
 
 
+//  Attractor kernel: batch Step with ATT::Step resolved at compile time
+//      class ATT : public attractorKernel<ATT, BASE>
+////////////////////////////////////////////////////////////////////////////
+template <class ATT, class BASE> class attractorKernel : public BASE
+{
+public:
+    void Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements);
+    void Step(float *&ptr, multiOrbitClass &orbits, uint numElements);
+};
+
+//  Attractor kernel w/ selectable precision of transcendental functions:
+//  ATT::StepM<MATH>(v, vp) is the step algorithm, MATH is attMath<...>
+//      class ATT : public attractorMathKernel<ATT, BASE>
+////////////////////////////////////////////////////////////////////////////
+template <class ATT, class BASE> class attractorMathKernel : public BASE
+{
+public:
+    attractorMathKernel() { this->isMathType = true; }
+
+    void Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements);
+    void Step(float *&ptr, multiOrbitClass &orbits, uint numElements);
+    void Step(vec3 &v, vec3 &vp);
+};
+
+//  d(x,y,z)/dt kernel: ATT::Deriv(v, dv) is the vector field, Step
+//  integrates it w/ selected method (dtIntegrators) over dtStepInc
+//  MATH = true: ATT::DerivM<MATH>(v, dv) w/ selectable precision (attMath)
+//      class ATT : public attractorDtKernel<ATT, MATH>
+////////////////////////////////////////////////////////////////////////////
+template <class ATT, bool MATH = false> class attractorDtKernel : public attractorDtType
+{
+public:
+    attractorDtKernel() { this->isMathType = MATH; }
+
+    void Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements);
+    void Step(float *&ptr, multiOrbitClass &orbits, uint numElements);
+    void Step(vec3 &v, vec3 &vp);
+};
+
 //  Hopalong base class
 ////////////////////////////////////////////////////////////////////////////
 class Hopalong : public attractorScalarK
@@ -380,7 +593,7 @@ public:
         float temp = kVal[6];
         for (int i = 0; i<getKSize(); i++) kVal[i] = RANDOM(kMin,kMax);
         
-        kVal[0] = (float)rand() / (float)RAND_MAX;
+        kVal[0] = attRng().get();
 
         kVal[6] = temp;
 
@@ -390,7 +603,7 @@ private:
     float step;
     float _zy, _x, _y, oldZ, _r;
 
-    float getRnadomK() { return 10. * (float)rand() / (float)RAND_MAX; }
+    float getRnadomK() { return 10. * attRng().get(); }
 
 };
 
@@ -399,7 +612,11 @@ private:
 //--------------------------------------------------------------------------
 
 //  Polinomial base class
+//  Step: orders 2..POWERN3D_MAX_SPECIALIZED w/ unrolled monomials resolved
+//  at compile time (selected once for each batch), StepN for other orders
 ////////////////////////////////////////////////////////////////////////////
+#define POWERN3D_MAX_SPECIALIZED 8
+
 class PowerN3D : public attractorVectorK
 {
 public:
@@ -415,7 +632,10 @@ public:
         resetData();
     }
 
+    void Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements);
+    void Step(float *&ptr, multiOrbitClass &orbits, uint numElements);
     void Step(vec3 &v, vec3 &vp);
+    void StepN(vec3 &v, vec3 &vp);
     void startData();
 
     void searchAttractor()  { searchLyapunov(); }
@@ -435,8 +655,6 @@ public:
     void saveAdditionalData(Config &cfg);
     void loadAdditionalData(Config &cfg);
 
-    void additionalDataCtrls();
-
     void saveVals(const char *name);
     void loadVals(const char *name);
     
@@ -450,7 +668,7 @@ public:
 
         kVal.resize(nCoeff);
 
-        newRandomValues();
+        randomValues(attRng().nextSeed());
 
         resetQueue();
         Insert(vVal[0]);
@@ -461,8 +679,7 @@ public:
 
     void newRandomValues()
     {
-        for(int i=0; i<nCoeff; i++)
-            kVal[i] = vec3(RANDOM(kMin,kMax),RANDOM(kMin,kMax),RANDOM(kMin,kMax));
+        attRng().fill((float *) kVal.data(), nCoeff*3, kMin, kMax);
 
         vVal[0] = vec3(RANDOM(vMin,vMax),RANDOM(vMin,vMax),RANDOM(vMin,vMax));
     }
@@ -475,18 +692,21 @@ private:
     void resetData() {
         nCoeff = getNumCoeff();
 
-        //elv.clear();
-        elv.resize(order+1);
-
-        //cf.clear();
-        cf.resize(nCoeff);
+        // exponents x, y, z of each coefficient, for StepN
+        monomials.clear();
+        for(int x=order-1; x>=0; x--)
+            for(int y=order-1; y>=0; y--)
+                for(int z=order-1; z>=0; z--) 
+                    if(x+y+z <= order) monomials.insert(monomials.end(), { x, y, z });
 
+        monomials.insert(monomials.end(), { order, 0, 0,  0, order, 0,  0, 0, order });
     }
 
-    vector<vec3> elv;
-    vector<float> cf;
     int nCoeff;
     int order, tmpOrder;
+    vector<int> monomials;
+
+    friend class attractorDlgClass;
 };
 
 //  Polinomial base class
@@ -503,12 +723,12 @@ protected:
 };
 
 /////////////////////////////////////////////////
-class PolynomialA : public PolynomialBase
+class PolynomialA : public attractorKernel<PolynomialA, PolynomialBase>
 {
 public:
     PolynomialA() { stepFn = (stepPtrFn) &PolynomialA::Step; }
-protected:
     void Step(vec3 &v, vec3 &vp);
+protected:
     void startData();
 /*
     void newRandomValues ()
@@ -525,52 +745,52 @@ protected:
 };
 
 /////////////////////////////////////////////////
-class PolynomialB : public PolynomialBase
+class PolynomialB : public attractorKernel<PolynomialB, PolynomialBase>
 {
 public:
     PolynomialB() { stepFn = (stepPtrFn) &PolynomialB::Step; }
-protected:
     void Step(vec3 &v, vec3 &vp);
+protected:
     void startData();
 };
 
 /////////////////////////////////////////////////
-class PolynomialC : public PolynomialBase
+class PolynomialC : public attractorKernel<PolynomialC, PolynomialBase>
 {
 public:
     PolynomialC() { stepFn = (stepPtrFn) &PolynomialC::Step; }
-protected:
     void Step(vec3 &v, vec3 &vp);
+protected:
     void startData();
 };
 
 /////////////////////////////////////////////////
-class PolynomialABS : public PolynomialBase
+class PolynomialABS : public attractorKernel<PolynomialABS, PolynomialBase>
 {
 public:
     PolynomialABS() { stepFn = (stepPtrFn) &PolynomialABS::Step; }
-protected:
     void Step(vec3 &v, vec3 &vp);
+protected:
     void startData();
 };
 
 /////////////////////////////////////////////////
-class PolynomialPow : public PolynomialBase
+class PolynomialPow : public attractorMathKernel<PolynomialPow, PolynomialBase>
 {
 public:
     PolynomialPow() { stepFn = (stepPtrFn) &PolynomialPow::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 
 /////////////////////////////////////////////////
-class PolynomialSin : public PolynomialBase
+class PolynomialSin : public attractorMathKernel<PolynomialSin, PolynomialBase>
 {
 public:
     PolynomialSin() { stepFn = (stepPtrFn) &PolynomialSin::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 
@@ -587,102 +807,102 @@ protected:
     void searchAttractor()  { searchLyapunov(); }
 };
 /////////////////////////////////////////////////
-class Rampe01 : public RampeBase
+class Rampe01 : public attractorMathKernel<Rampe01, RampeBase>
 {
 public:
     Rampe01() { stepFn = (stepPtrFn) &Rampe01::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe02 : public RampeBase
+class Rampe02 : public attractorMathKernel<Rampe02, RampeBase>
 {
 public:
     Rampe02() { stepFn = (stepPtrFn) &Rampe02::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe03 : public RampeBase
+class Rampe03 : public attractorMathKernel<Rampe03, RampeBase>
 {
 public:
     Rampe03() { stepFn = (stepPtrFn) &Rampe03::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe03A : public RampeBase
+class Rampe03A : public attractorMathKernel<Rampe03A, RampeBase>
 {
 public:
     Rampe03A() { stepFn = (stepPtrFn) &Rampe03A::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe04 : public RampeBase
+class Rampe04 : public attractorMathKernel<Rampe04, RampeBase>
 {
 public:
     Rampe04() { stepFn = (stepPtrFn) &Rampe04::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe05 : public RampeBase
+class Rampe05 : public attractorMathKernel<Rampe05, RampeBase>
 {
 public:
     Rampe05() { stepFn = (stepPtrFn) &Rampe05::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe06 : public RampeBase
+class Rampe06 : public attractorMathKernel<Rampe06, RampeBase>
 {
 public:
     Rampe06() { stepFn = (stepPtrFn) &Rampe06::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe07 : public RampeBase
+class Rampe07 : public attractorMathKernel<Rampe07, RampeBase>
 {
 public:
     Rampe07() { stepFn = (stepPtrFn) &Rampe07::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe08 : public RampeBase
+class Rampe08 : public attractorMathKernel<Rampe08, RampeBase>
 {
 public:
     Rampe08() { stepFn = (stepPtrFn) &Rampe08::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe09 : public RampeBase
+class Rampe09 : public attractorMathKernel<Rampe09, RampeBase>
 {
 public:
     Rampe09() { stepFn = (stepPtrFn) &Rampe09::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 /////////////////////////////////////////////////
-class Rampe10 : public RampeBase
+class Rampe10 : public attractorMathKernel<Rampe10, RampeBase>
 {
 public:
     Rampe10() { stepFn = (stepPtrFn) &Rampe10::Step; }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
 };
 
@@ -692,7 +912,7 @@ protected:
 
 //  KingsDream base class
 ////////////////////////////////////////////////////////////////////////////
-class KingsDream : public attractorScalarK
+class KingsDream : public attractorMathKernel<KingsDream, attractorScalarK>
 {
 public:
     KingsDream() { 
@@ -700,15 +920,15 @@ public:
         vMin = -0.5; vMax = 0.5; kMin = -2.0; kMax = 2.0;
         m_POV = vec3( 0.f, 0, 10.f);
     }
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
     void searchAttractor()  { searchLyapunov(); }
 };
 
 //  Pickover base class
 ////////////////////////////////////////////////////////////////////////////
-class Pickover : public attractorScalarK
+class Pickover : public attractorMathKernel<Pickover, attractorScalarK>
 {
 public:
 
@@ -720,15 +940,15 @@ public:
         m_POV = vec3( 0.f, 0, 7.f);
     }
 
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
     void searchAttractor()  { searchLyapunov(); }
 };
 
 //  SinCos base class
 ////////////////////////////////////////////////////////////////////////////
-class SinCos : public attractorScalarK
+class SinCos : public attractorMathKernel<SinCos, attractorScalarK>
 {
 public:
 
@@ -742,8 +962,8 @@ public:
         m_POV = vec3( 0.f, 0, 12.f);
     }
 
+    template <class MATH> void StepM(vec3 &v, vec3 &vp);
 protected:
-    void Step(vec3 &v, vec3 &vp);
     void startData();
     void searchAttractor()  { searchLyapunov(); }
 };
@@ -754,7 +974,7 @@ protected:
 
 //  Lorenz base class
 ////////////////////////////////////////////////////////////////////////////
-class Lorenz : public attractorDtType
+class Lorenz : public attractorDtKernel<Lorenz>
 {
 public:
 
@@ -765,7 +985,7 @@ public:
         m_POV = vec3(0.f, .0, 40.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 /*
     void Step()
@@ -781,9 +1001,9 @@ public:
 */
     void newRandomValues()
     {
-        kVal[0] = (float)rand()/(float)RAND_MAX * 20.f;
-        kVal[1] = (float)rand()/(float)RAND_MAX * 56.f;
-        kVal[2] = (float)rand()/(float)RAND_MAX * (16/3.f);
+        kVal[0] = attRng().get() * 20.f;
+        kVal[1] = attRng().get() * 56.f;
+        kVal[2] = attRng().get() * (16/3.f);
 
     }
 
@@ -793,7 +1013,7 @@ public:
 
 //  ChenLee base class
 ////////////////////////////////////////////////////////////////////////////
-class ChenLee : public attractorDtType
+class ChenLee : public attractorDtKernel<ChenLee>
 {
 public:
 
@@ -803,13 +1023,13 @@ public:
         m_POV = vec3( 0.f, 0, 50.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  TSUCS1 base class
 ////////////////////////////////////////////////////////////////////////////
-class TSUCS : public attractorDtType
+class TSUCS : public attractorDtKernel<TSUCS>
 {
 public:
 
@@ -819,13 +1039,13 @@ public:
         m_POV = vec3( 0.f, 0, 240.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Aizawa
 ////////////////////////////////////////////////////////////////////////////
-class Aizawa : public attractorDtType
+class Aizawa : public attractorDtKernel<Aizawa>
 {
 public:
 
@@ -835,13 +1055,13 @@ public:
         m_POV = vec3( 0.f, 0, 10.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  YuWang
 ////////////////////////////////////////////////////////////////////////////
-class YuWang : public attractorDtType
+class YuWang : public attractorDtKernel<YuWang, true>
 {
 public:
 
@@ -851,13 +1071,13 @@ public:
         m_POV = vec3( 0.f, 0, 10.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    template <class MATH> void DerivM(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  FourWing
 ////////////////////////////////////////////////////////////////////////////
-class FourWing : public attractorDtType
+class FourWing : public attractorDtKernel<FourWing>
 {
 public:
 
@@ -867,13 +1087,13 @@ public:
         m_POV = vec3( 0.f, 0, 30.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  FourWing2
 ////////////////////////////////////////////////////////////////////////////
-class FourWing2 : public attractorDtType
+class FourWing2 : public attractorDtKernel<FourWing2>
 {
 public:
 
@@ -883,13 +1103,13 @@ public:
         m_POV = vec3( 0.f, 0, 100.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  FourWing3
 ////////////////////////////////////////////////////////////////////////////
-class FourWing3 : public attractorDtType
+class FourWing3 : public attractorDtKernel<FourWing3>
 {
 public:
 
@@ -899,13 +1119,13 @@ public:
         m_POV = vec3( 0.f, 0, 70.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Thomas
 ////////////////////////////////////////////////////////////////////////////
-class Thomas : public attractorDtType
+class Thomas : public attractorDtKernel<Thomas, true>
 {
 public:
 
@@ -915,13 +1135,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    template <class MATH> void DerivM(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Halvorsen
 ////////////////////////////////////////////////////////////////////////////
-class Halvorsen : public attractorDtType
+class Halvorsen : public attractorDtKernel<Halvorsen>
 {
 public:
 
@@ -931,13 +1151,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Arneodo 
 ////////////////////////////////////////////////////////////////////////////
-class Arneodo : public attractorDtType
+class Arneodo : public attractorDtKernel<Arneodo>
 {
 public:
 
@@ -947,13 +1167,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Bouali 
 ////////////////////////////////////////////////////////////////////////////
-class Bouali : public attractorDtType
+class Bouali : public attractorDtKernel<Bouali>
 {
 public:
 
@@ -963,13 +1183,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Hadley
 ////////////////////////////////////////////////////////////////////////////
-class Hadley : public attractorDtType
+class Hadley : public attractorDtKernel<Hadley>
 {
 public:
 
@@ -979,13 +1199,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  LiuChen
 ////////////////////////////////////////////////////////////////////////////
-class LiuChen : public attractorDtType
+class LiuChen : public attractorDtKernel<LiuChen>
 {
 public:
 
@@ -995,13 +1215,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  GenesioTesi
 ////////////////////////////////////////////////////////////////////////////
-class GenesioTesi : public attractorDtType
+class GenesioTesi : public attractorDtKernel<GenesioTesi>
 {
 public:
 
@@ -1011,13 +1231,13 @@ public:
         m_POV = vec3( 0.f, 0, 10.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  NewtonLeipnik
 ////////////////////////////////////////////////////////////////////////////
-class NewtonLeipnik : public attractorDtType
+class NewtonLeipnik : public attractorDtKernel<NewtonLeipnik>
 {
 public:
 
@@ -1027,13 +1247,13 @@ public:
         m_POV = vec3( 0.f, 0, 10.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  NoseHoover
 ////////////////////////////////////////////////////////////////////////////
-class NoseHoover : public attractorDtType
+class NoseHoover : public attractorDtKernel<NoseHoover>
 {
 public:
 
@@ -1043,13 +1263,13 @@ public:
         m_POV = vec3( 0.f, 0, 10.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  RayleighBenard
 ////////////////////////////////////////////////////////////////////////////
-class RayleighBenard : public attractorDtType
+class RayleighBenard : public attractorDtKernel<RayleighBenard>
 {
 public:
 
@@ -1059,13 +1279,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Sakarya  
 ////////////////////////////////////////////////////////////////////////////
-class Sakarya : public attractorDtType
+class Sakarya : public attractorDtKernel<Sakarya>
 {
 public:
 
@@ -1075,13 +1295,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Robinson
 ////////////////////////////////////////////////////////////////////////////
-class Robinson : public attractorDtType
+class Robinson : public attractorDtKernel<Robinson>
 {
 public:
 
@@ -1091,13 +1311,13 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 //  Rossler
 ////////////////////////////////////////////////////////////////////////////
-class Rossler : public attractorDtType
+class Rossler : public attractorDtKernel<Rossler>
 {
 public:
 
@@ -1107,14 +1327,14 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
 
 //  Rucklidge
 ////////////////////////////////////////////////////////////////////////////
-class Rucklidge : public attractorDtType
+class Rucklidge : public attractorDtKernel<Rucklidge>
 {
 public:
 
@@ -1124,40 +1344,39 @@ public:
         m_POV = vec3( 0.f, 0, 20.f);
     }
 
-    void Step(vec3 &v, vec3 &vp);
+    void Deriv(const vec3 &v, vec3 &dv);
     void startData();
 };
 
-//  Magnetic base class
+//  Magnetic base class: magnet i in vVal (position) and kVal (strength)
+//  Step: sum of k * (p-v)/|p-v|^2, w/ xyz permutation of (i % classes)
+//  in derived magneticKernel<PERM>
 ////////////////////////////////////////////////////////////////////////////
 class Magnetic : public attractorVectorK
 {
 public:
 
-    typedef  const vec3 (Magnetic::*magneticPtrFn)(const vec3 &, int);
     Magnetic() 
     {
-        stepFn = (stepPtrFn) &ChenLee::Step;    
         kMax = 5.0; kMin = -5.0; vMax = 1.0; vMin = -1.0;
 
         m_POV = vec3( 0.f, 0.f, 3.f);
     }
 
     void initStep() {
+        valuesChanged();
         resetQueue();
         Insert(vec3(0.f));
     }
 
-    void Step(vec3 &v, vec3 &vp);
-    void startData();
+    //magnets edited: SoA of magnets rebuilt by kernels
+    void setValue(int i, int type, float val) { attractorVectorK::setValue(i, type, val); valuesChanged(); }
+    void setValue(int row, int col, int type, float val) { attractorVectorK::setValue(row, col, type, val); valuesChanged(); }
 
-    //  innerSteps functions
-    ///////////////////////////////////////
-    const vec3 straight(const vec3 &vx, int i);
-    const vec3 rightShift(const vec3 &vx, int i);
-    const vec3 leftShift(const vec3 &vx, int i);
-    const vec3 fullPermutated(const vec3 &vx, int i);
-    const vec3 tryed(const vec3 &vx, int i);
+    //changes on each kVal/vVal change, unique among all Magnetic objects
+    uint64_t getValuesGeneration() { return valuesGeneration; }
+
+    void startData();
 
     //  Load/Save funcs
     ///////////////////////////////////////
@@ -1169,18 +1388,13 @@ public:
     void saveAdditionalData(Config &cfg);
     void loadAdditionalData(Config &cfg);
 
-    //  Additional Controls
-    ///////////////////////////////////////
-    void additionalDataCtrls();
-    int additionalDataDlg();
-
     void setElements(const int n)
     { 
         newItemsEnd = true;
         //clear();
         vVal.resize(n); kVal.resize(n); 
 
-        newRandomValues();
+        randomValues(attRng().nextSeed());
 
         newItemsEnd = false;
     }
@@ -1209,6 +1423,8 @@ public:
         }
         //ResizeVectors(); 
         resetQueue(); 
+        seed = 0;   // new magnets are not from seed
+        valuesChanged();
         newItemsEnd = false;
     }
 
@@ -1236,11 +1452,15 @@ protected:
     thread *th[4];
     vec3 vth[4],vcurr;
 
-    magneticPtrFn increment;
     bool newItemsEnd = false;
 
+    void valuesChanged() { valuesGeneration = newGeneration(); }
+    static uint64_t newGeneration();
+    std::atomic<uint64_t> valuesGeneration { newGeneration() };
+
     int tmpElements, nElements;
 
+    friend class attractorDlgClass;
 
     friend void fillMagneticData();
 /*
@@ -1260,41 +1480,129 @@ protected:
         const float _dUP =  vMax;
         const float _dDW =  vMin;
 
-        for(auto &i : vVal) i = vec3(RANDOM(_dDW,_dUP), RANDOM(_dDW,_dUP), RANDOM(_dDW,_dUP));
-        for(auto &i : kVal) i = vec3(RANDOM(_kDW,_kUP), RANDOM(_kDW,_kUP), RANDOM(_kDW,_kUP));
+        attRng().fill((float *) vVal.data(), vVal.size()*3, _dDW, _dUP);
+        attRng().fill((float *) kVal.data(), kVal.size()*3, _kDW, _kUP);
 
         initStep();
     }
 };
 
+//  xyz permutations of magnets contributions: magnet i is in class
+//  (i % classes), permutations are linear: applied to sum of each class
+///////////////////////////////////////
+struct magneticRightShift {
+    enum { classes = 3 };
+    static vec3 permute(const vec3 &v, int c) {
+        return c == 0 ? v : (c == 1 ? vec3(v.z, v.x, v.y) : vec3(v.y, v.z, v.x));
+    }
+};
+
+struct magneticLeftShift {
+    enum { classes = 3 };
+    static vec3 permute(const vec3 &v, int c) {
+        return c == 0 ? v : (c == 1 ? vec3(v.y, v.z, v.x) : vec3(v.z, v.x, v.y));
+    }
+};
+
+struct magneticFullPermutated {
+    enum { classes = 6 };
+    static vec3 permute(const vec3 &v, int c) {
+        switch(c) {
+            case 1 :  return vec3(v.y, v.z, v.x);
+            case 2 :  return vec3(v.z, v.x, v.y);
+            case 3 :  return vec3(v.x, v.z, v.y);
+            case 4 :  return vec3(v.z, v.y, v.x);
+            case 5 :  return vec3(v.y, v.x, v.z);
+            default:  return v;
+        }
+    }
+};
+
+//  Magnetic kernel: permutation resolved at compile time, magnets copied
+//  in SoA arrays (for each thread, when values change), loop over magnets
+//  is vectorized
+///////////////////////////////////////
+template <class PERM> class magneticKernel : public Magnetic
+{
+public:
+    void Step(float *&ptr, vec3 &v, vec3 &vp, uint numElements);
+    void Step(float *&ptr, multiOrbitClass &orbits, uint numElements);
+    void Step(vec3 &v, vec3 &vp);
+};
+
 //  Magnetic LeftShift
 ///////////////////////////////////////
-class MagneticLeft : public Magnetic {
+class MagneticLeft : public magneticKernel<magneticLeftShift> {
 public:
-    MagneticLeft() {
-        increment = &Magnetic::leftShift;
-    }
+    MagneticLeft() { stepFn = (stepPtrFn) &MagneticLeft::Step; }
 };
 
 //  Magnetic RightShift
 ///////////////////////////////////////
-class MagneticRight : public Magnetic {
+class MagneticRight : public magneticKernel<magneticRightShift> {
 public:
-    MagneticRight() {
-        increment = &Magnetic::rightShift;
-    }
+    MagneticRight() { stepFn = (stepPtrFn) &MagneticRight::Step; }
 };
 
 //  Magnetic Full permutated
 ///////////////////////////////////////
-class MagneticFull : public Magnetic {
+class MagneticFull : public magneticKernel<magneticFullPermutated> {
 public:
-    MagneticFull() {
-        increment = &Magnetic::fullPermutated;
-    }
+    MagneticFull() { stepFn = (stepPtrFn) &MagneticFull::Step; }
 };
 
 
+//  Vertex formats of emitted points (xyz + speed): float, or packed in 8
+//  bytes as half float or unsigned normalized 16 bit, quantized in box
+//  [qMin, qMin+qScale) fitted at emission start, grown (and emission
+//  restarted) when emitted points are out of it. Decoded in vertex shaders
+//  as qMin + attrib * qScale (identity for float and half)
+////////////////////////////////////////////////////////////////////////////
+
+//VBO vertex layout: float4 (16 bytes), half4 or unorm16x4 (8 bytes)
+enum vertexFormat { vtxFmtFloat, vtxFmtHalf, vtxFmtUnorm16, vtxFmtNum };
+
+#define VERTEX_FIT_POINTS 16384
+#define VERTEX_FIT_SKIP    4096
+
+struct vertexPacking
+{
+    int format = vtxFmtFloat;
+    vec4 qMin = vec4(0.f), qScale = vec4(1.f);
+
+    int getBytesPerVertex() const { return format == vtxFmtFloat ? 4*sizeof(float) : 4*sizeof(uint16_t); }
+    bool isPacked() const { return format != vtxFmtFloat; }
+
+    //box of VERTEX_FIT_POINTS steps from v (first VERTEX_FIT_SKIP skipped)
+    void fit(AttractorBase *att, vec3 v);
+    //unorm16 box from bounds of points (identity for float and half)
+    void setBox(const vec4 &vMin, const vec4 &vMax);
+    //unorm16 box grown to include bounds, w/ margin as fit
+    void extend(const vec4 &vMin, const vec4 &vMax);
+    //n points (4 floats) from src to dst in format: false if points out of
+    //box are clamped (unorm16), then bounds of points and box in bMin/bMax
+    bool pack(const float *src, void *dst, uint n, vec4 *bMin = nullptr, vec4 *bMax = nullptr) const;
+    //n points in format from src to dst (4 floats)
+    void unpack(const void *src, float *dst, uint n) const;
+};
+
+//  Emission job: points [claimed, end) of buffer (point i at (i%wrap)*4)
+//  split in STEP_BATCH_SIZE chunks, claimed by workers and published in
+//  order, so *target is always the count of contiguous completed points
+////////////////////////////////////////////////////////////////////////////
+struct stepJobData
+{
+    float *buffer;
+    const vertexPacking *packing;
+    uint64_t wrap, end;
+    std::atomic<uint64_t> *target;
+    std::atomic<uint64_t> claimed, published;
+
+    AttractorBase *att;
+    vec3 startPoint;
+    int nOrbits;
+};
+
 //  Attractors Thread helper class
 ////////////////////////////////////////////////////////////////////////////
 class threadStepClass
@@ -1303,6 +1611,10 @@ public:
     threadStepClass(emitterBaseClass *e) : emitter(e) { newThread(); }
     ~threadStepClass() { deleteThread(); }
 
+    //emission pool: fills buffer from start to end with all workers
+    void fillBuffer(float *buffer, uint64_t wrap, uint64_t start, uint64_t end, std::atomic<uint64_t> &emitted);
+    int getNumWorkers() { return workers.size()+1; }
+
     void newThread();
     void deleteThread();
     void startThread(bool startOn=true);
@@ -1317,10 +1629,68 @@ public:
 
     bool canStart();
 
+    //render thread, once per frame: merges workers statistics in attractor
+    void collectStats();
+
 private:
+    void workerLoop(int idx);
+    void stepChunks(int idx);
+    bool canStep();
+
     emitterBaseClass *emitter = nullptr;
     thread *attractorLoop = nullptr;
 
+    // worker 0 is attractorLoop: it follows the main orbit
+    vector<thread *> workers;
+    vector<multiOrbitClass> workersOrbits;
+
+    stepJobData job;
+    std::mutex poolMutex;
+    std::condition_variable poolCondVar;
+    uint jobID = 0;
+    bool poolExit = false;
+    std::atomic<int> workersBusy;
+
+    // workers partials, merged at end of each job
+    emissionStats pendingStats;
+    std::mutex statsMutex;
+};
+
+//  Random attractors search in background: each worker evaluates candidates
+//  (newRandomValues + searchAttractor) on its own copy of the attractor,
+//  accepted candidates are queued as "Attractor" nodes
+////////////////////////////////////////////////////////////////////////////
+#define SEARCH_MAX_RESULTS 8
+
+class attractorSearchClass
+{
+public:
+    ~attractorSearchClass() { stop(); }
+
+    //workers start from a copy of att values (nThreads = 0: cores - 1)
+    void start(AttractorBase *att, int nThreads = 0);
+    //cancel and join workers, queued results are discarded
+    void stop();
+
+    bool isRunning() { return !workers.empty(); }
+    //att has same type and settings (limits, order...) of search
+    bool isSameSearch(AttractorBase *att);
+    //oldest accepted candidate: false if none is ready
+    bool popResult(Config &cfg);
+    int getFound() { return found; }
+
+private:
+    void worker(Config cfg);
+    static Config searchSettings(AttractorBase *att);
+
+    vector<thread *> workers;
+    std::atomic<bool> cancel { false };
+    std::atomic<int> found { 0 };
+    Config settings;
+
+    deque<Config> results;
+    std::mutex resultsMutex;
+    std::condition_variable resultsCondVar;
 };
 
 //  Attractor Class container
@@ -1328,74 +1698,88 @@ private:
 #define ATT_PATH "startData/"
 #define ATT_EXT ".sca"
 
-#define PB(ATT,DISPLAY_NAME) ptr.push_back(new ATT());\
-                             ptr.back()->fileName = (ATT_PATH #ATT ATT_EXT);\
-                             ptr.back()->nameID = (#ATT);\
-                             ptr.back()->displayName = (DISPLAY_NAME);
-
-
+//  Registered attractors: ATT_ENTRY(class, display name)
+#define ATTRACTORS_LIST(ATT_ENTRY) \
+        ATT_ENTRY(MagneticRight , "Magnetic Right" ) \
+        ATT_ENTRY(MagneticLeft  , "Magnetic Left"  ) \
+        ATT_ENTRY(MagneticFull  , "Magnetic Full"  ) \
+        ATT_ENTRY(PolynomialA   , "Polynomial A"   ) \
+        ATT_ENTRY(PolynomialB   , "Polynomial B"   ) \
+        ATT_ENTRY(PolynomialC   , "Polynomial C"   ) \
+        ATT_ENTRY(PolynomialABS , "Polynomial Abs" ) \
+        ATT_ENTRY(PolynomialPow , "Polynomial Pow" ) \
+        ATT_ENTRY(PolynomialSin , "Polynomial Sin" ) \
+        ATT_ENTRY(PowerN3D      , "Polynom N-order") \
+        ATT_ENTRY(Rampe01       , "Rampe  1"       ) \
+        ATT_ENTRY(Rampe02       , "Rampe  2"       ) \
+        ATT_ENTRY(Rampe03       , "Rampe  3"       ) \
+        ATT_ENTRY(Rampe03A      , "Rampe  3 mod"   ) \
+        ATT_ENTRY(Rampe04       , "Rampe  4"       ) \
+        ATT_ENTRY(Rampe05       , "Rampe  5"       ) \
+        ATT_ENTRY(Rampe06       , "Rampe  6"       ) \
+        ATT_ENTRY(Rampe07       , "Rampe  7"       ) \
+        ATT_ENTRY(Rampe08       , "Rampe  8"       ) \
+        ATT_ENTRY(Rampe09       , "Rampe  9"       ) \
+        ATT_ENTRY(Rampe10       , "Rampe 10"       ) \
+        ATT_ENTRY(KingsDream    , "King's Dream"   ) \
+        ATT_ENTRY(Pickover      , "Pickover"       ) \
+        ATT_ENTRY(SinCos        , "Sin Cos"        ) \
+        ATT_ENTRY(Lorenz        , "Lorenz"         ) \
+        ATT_ENTRY(ChenLee       , "Chen Lee"       ) \
+        ATT_ENTRY(TSUCS         , "TSUCS 1&2"      ) \
+        ATT_ENTRY(Aizawa        , "Aizawa"         ) \
+        ATT_ENTRY(YuWang        , "Yu-Wang"        ) \
+        ATT_ENTRY(FourWing      , "Four Wing"      ) \
+        ATT_ENTRY(FourWing2     , "Four Wing 2"    ) \
+        ATT_ENTRY(FourWing3     , "Four Wing 3"    ) \
+        ATT_ENTRY(Thomas        , "Thomas"         ) \
+        ATT_ENTRY(Halvorsen     , "Halvorsen"      ) \
+        ATT_ENTRY(Arneodo       , "Arneodo"        ) \
+        ATT_ENTRY(Bouali        , "Bouali"         ) \
+        ATT_ENTRY(Hadley        , "Hadley"         ) \
+        ATT_ENTRY(LiuChen       , "LiuChen"        ) \
+        ATT_ENTRY(GenesioTesi   , "GenesioTesi"    ) \
+        ATT_ENTRY(NewtonLeipnik , "NewtonLeipnik"  ) \
+        ATT_ENTRY(NoseHoover    , "NoseHoover"     ) \
+        ATT_ENTRY(RayleighBenard, "RayleighBenard" ) \
+        ATT_ENTRY(Sakarya       , "Sakarya"        ) \
+        ATT_ENTRY(Robinson      , "Robinson"       ) \
+        ATT_ENTRY(Rossler       , "Rossler"        ) \
+        ATT_ENTRY(Rucklidge     , "Rucklidge"      ) \
+      /*ATT_ENTRY(Hopalong      , "Hopalong"       ) */
+
+#define PB(ATT,DISPLAY_NAME) ptr.push_back(initAttractor(new ATT(), #ATT, DISPLAY_NAME));
+#define NEW_ATT(ATT,DISPLAY_NAME) if(nameID == #ATT) att = initAttractor(new ATT(), #ATT, DISPLAY_NAME);
 
 class AttractorsClass 
 {
 public:
     AttractorsClass() {
-        PB(MagneticRight , "Magnetic Right" )
-        PB(MagneticLeft  , "Magnetic Left"  )
-        PB(MagneticFull  , "Magnetic Full"  )
-        PB(PolynomialA   , "Polynomial A"   )
-        PB(PolynomialB   , "Polynomial B"   )
-        PB(PolynomialC   , "Polynomial C"   )
-        PB(PolynomialABS , "Polynomial Abs" )
-        PB(PolynomialPow , "Polynomial Pow" )
-        PB(PolynomialSin , "Polynomial Sin" )
-        PB(PowerN3D      , "Polynom N-order")
-        PB(Rampe01       , "Rampe  1"       )
-        PB(Rampe02       , "Rampe  2"       )
-        PB(Rampe03       , "Rampe  3"       )
-        PB(Rampe03A      , "Rampe  3 mod"   )
-        PB(Rampe04       , "Rampe  4"       )
-        PB(Rampe05       , "Rampe  5"       )
-        PB(Rampe06       , "Rampe  6"       )
-        PB(Rampe07       , "Rampe  7"       )
-        PB(Rampe08       , "Rampe  8"       )
-        PB(Rampe09       , "Rampe  9"       )
-        PB(Rampe10       , "Rampe 10"       )
-        PB(KingsDream    , "King's Dream"   )
-        PB(Pickover      , "Pickover"       )
-        PB(SinCos        , "Sin Cos"        )
-        PB(Lorenz        , "Lorenz"         )
-        PB(ChenLee       , "Chen Lee"       )
-        PB(TSUCS         , "TSUCS 1&2"      )
-        PB(Aizawa        , "Aizawa"         )
-        PB(YuWang        , "Yu-Wang"        )
-        PB(FourWing      , "Four Wing"      )
-        PB(FourWing2     , "Four Wing 2"    )
-        PB(FourWing3     , "Four Wing 3"    )
-        PB(Thomas        , "Thomas"         )
-        PB(Halvorsen     , "Halvorsen"      )
-        PB(Arneodo       , "Arneodo"        )
-        PB(Bouali        , "Bouali"         )
-        PB(Hadley        , "Hadley"         )
-        PB(LiuChen       , "LiuChen"        )
-        PB(GenesioTesi   , "GenesioTesi"    )
-        PB(NewtonLeipnik , "NewtonLeipnik"  )
-        PB(NoseHoover    , "NoseHoover"     )
-        PB(RayleighBenard, "RayleighBenard" )
-        PB(Sakarya       , "Sakarya"        )
-        PB(Robinson      , "Robinson"       )
-        PB(Rossler       , "Rossler"        )
-        PB(Rucklidge     , "Rucklidge"      )
-          
-            
-            
-
-        //PB(Hopalong          , "Hopalong"      )
+        ATTRACTORS_LIST(PB)
 
         selected = -1;
 
         loadStartData();
     }
+
+    //new independent attractor, w/ start data: nullptr if nameID is unknown
+    static AttractorBase *newAttractor(const string &nameID) {
+        AttractorBase *att = nullptr;
+        ATTRACTORS_LIST(NEW_ATT)
+        if(att) att->startData();
+        return att;
+    }
+
+private:
+    static AttractorBase *initAttractor(AttractorBase *att, const char *nameID, const char *displayName) {
+        att->fileName = ATT_PATH + string(nameID) + ATT_EXT;
+        att->nameID = nameID;
+        att->displayName = displayName;
+        return att;
+    }
+public:
 #undef PB
+#undef NEW_ATT
 #undef ATT_PATH
 #undef ATT_EXT 
 
@@ -1423,6 +1807,8 @@ public:
 
     void saveVals(Config &cfg);
     bool loadVals(Config &cfg);
+    //select and load attractor from its "Attractor" node: GL/UI free
+    bool loadSelected(Config &c);
 
     int  getSelection()      { return selected; }
     void setSelection(int i) { newSelection(i);  }
@@ -1458,6 +1844,22 @@ public:
 
     //thread func
     void endlessStep(emitterBaseClass *emitter);
+    //fill buffer w/o thread: single or multi-orbit, false if orbit is dead (emission to pause)
+    bool Step(float *ptr, uint numElements);
+
+    //emission health (UI): last dead orbit found and reseeds in this emission
+    int getHealth() { return health; }
+    int getReseeds() { return reseeds; }
+    void resetHealth() { health = emitHealthy; reseeds = 0; }
+    //dead orbit found (any thread): true if it can be reseeded, false if emission must be paused
+    bool reportDeadOrbit(int h) { health = h; return reseeds.fetch_add(1) < HEALTH_RESEEDS_MAX; }
+    //new start point near v (last good state)
+    static vec3 reseedNear(const vec3 &v) {
+        const float spread = MULTI_ORBIT_SPREAD * (1.f + length(v));
+        return v + vec3(RANDOM(-spread, spread), RANDOM(-spread, spread), RANDOM(-spread, spread));
+    }
+
+    multiOrbitClass &getOrbits() { return orbits; }
 
     void queryStopThread() { endlessLoop=false; }
     void queryStartThread() { endlessLoop=true; }
@@ -1465,7 +1867,12 @@ public:
 
     void newStepThread(emitterBaseClass *e);
     void deleteStepThread();
+    //new random attractor from background search: applied by checkNewRandom
+    //as soon as ready, w/o stop the rendering
     void generateNewRandom();
+    void checkNewRandom();
+    void cancelNewRandom() { searchPending = false; search.stop(); }
+    bool isNewRandomPending() { return searchPending; }
 
     std::mutex &getStepMutex() { return stepMutex; }
 
@@ -1481,10 +1888,14 @@ private:
     //thread helper
     //bool breakLoop = false;
 
-    bool endlessLoop = true;
+    std::atomic<bool> endlessLoop { true };
+
+    std::atomic<int> health { emitHealthy };
+    std::atomic<int> reseeds { 0 };
 
     std::mutex stepMutex;
-    std::condition_variable stepCondVar;
+    std::condition_variable stepCondVar;    // wakes fill thread
+    std::condition_variable idleCondVar;    // fill thread is out of step
 
     std::mutex mtxStep;
 
@@ -1492,6 +1903,11 @@ private:
 
     threadStepClass *threadStep = nullptr;
 
+    multiOrbitClass orbits;
+
+    attractorSearchClass search;
+    bool searchPending = false;
+
     vector<AttractorBase *> ptr;
     int selected;
 
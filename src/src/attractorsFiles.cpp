@@ -33,381 +33,1087 @@
 //  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 ////////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <sstream>
+
 #include "glWindow.h"
 
 #include "attractorsBase.h"
+#include "chaosCore.h"
+
+//  Read only file mapping
+class mappedFile {
+public:
+    ~mappedFile() { close(); }
+
+    bool open(const char *name) {
+#ifdef _WIN32
+        hFile = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(hFile == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if(!GetFileSizeEx(hFile, &sz) || !sz.QuadPart) return false;
+        hMap = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(hMap == nullptr) return false;
+        ptr = (const uint8_t *) MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+        size = sz.QuadPart;
+#else
+        fd = ::open(name, O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st;
+        if(fstat(fd, &st) || !st.st_size) return false;
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED) return false;
+        madvise(p, st.st_size, MADV_SEQUENTIAL);
+        ptr = (const uint8_t *) p;
+        size = st.st_size;
+#endif
+        return ptr != nullptr;
+    }
 
-bool loadObjFile() 
-{  
-    //string line;         
-    attractorsList.getThreadStep()->stopThread();
-    char const * patterns[] = { "*.obj", "*.sca" };           
-    char const * fileName = theApp->openFile(nullptr, patterns, 2);
-
-    if(fileName==nullptr) return false;
-
-    ifstream ifs(fileName);
-    ifs.precision(5);
-        
-    GLuint nVtx;
-    ifs >> nVtx;
-
-    theWnd->getParticlesSystem()->getEmitter()->resetVBOindexes();
-    GLfloat *ptr = theWnd->getParticlesSystem()->getEmitter()->getVBO()->getBuffer();
-        //theWnd->getParticlesSystem()->getEmitter()->getVBO()->mapBuffer(nVtx);
-
-    vec3 lum(0.299, 0.587, 0.114), col(1.f), pt;
-    uint buffSize = theWnd->getParticlesSystem()->getEmitter()->getSizeStepBuffer();
-    theWnd->getParticlesSystem()->getEmitter()->setSizeCircularBuffer(nVtx);
-       
-    int j=0;
-    for(int i=0; i<nVtx; i++, j++) {
-
-        if(j == buffSize) {
-            theWnd->getParticlesSystem()->getEmitter()->getVBO()->uploadSubBuffer(buffSize,theWnd->getParticlesSystem()->getEmitter()->getSizeCircularBuffer());
-            ptr = theWnd->getParticlesSystem()->getEmitter()->getVBO()->getBuffer();
-            j=0;
-        }
+    void close() {
+#ifdef _WIN32
+        if(ptr) UnmapViewOfFile(ptr);
+        if(hMap != nullptr) CloseHandle(hMap);
+        if(hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+        hMap = nullptr; hFile = INVALID_HANDLE_VALUE;
+#else
+        if(ptr) munmap((void *) ptr, size);
+        if(fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        ptr = nullptr; size = 0;
+    }
 
-        ifs >> pt.x >> pt.y >> pt.z >>  col.r >> col.g >> col.b;
+    const uint8_t *data() { return ptr; }
+    uint64_t getSize() { return size; }
+
+private:
+    const uint8_t *ptr = nullptr;
+    uint64_t size = 0;
+#ifdef _WIN32
+    HANDLE hFile = INVALID_HANDLE_VALUE, hMap = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+//  Emitter ready to receive count imported vertices: step thread stopped
+//  and GPU not reading the buffer (mapped ring is written directly)
+static void resetEmitterForImport(emitterBaseClass *emitter, GLuint count)
+{
+    glFinish();
+    emitter->resetVBOindexes();
+    emitter->setColorData(false);
+#if defined(USE_THREAD_TO_FILL) && !defined(USE_MAPPED_BUFFER)
+    emitter->getVBO()->flushStaging();
+#endif
+    emitter->setSizeCircularBuffer(count);
+}
 
-        if(!(i%100000))
-            cout << i << endl;
+//  Exports read the ring back: step thread stopped (mapped ring is written
+//  directly, up to writeLimit) and its vertices flushed, emission state is
+//  returned to resume it after
+static bool pauseEmitterForExport(emitterBaseClass *emitter)
+{
+    const bool emitting = emitter->isEmitterOn();
+    attractorsList.getThreadStep()->stopThread();
+#ifdef USE_MAPPED_BUFFER
+    emitter->getVBO()->updateWriteRange(emitter->getSizeCircularBuffer());
+#endif
+    return emitting;
+}
 
-        *ptr++ = pt.x;
-        *ptr++ = pt.y;
-        *ptr++ = pt.z;
+//  Text points (.obj / .sca): vertices count, then a "x y z r g b" line for
+//  each vertex (rgb in [0,1]), other text layouts (ascii PLY) in textVertexLayout
+//  File is mapped and split on line boundaries in OBJ_PARSE_BLOCK chunks:
+//  lines are counted in parallel to get the first vertex of each chunk, then
+//  workers parse the chunks straight in their slice of a double buffered
+//  staging, uploaded by render thread while next batch is parsed
+////////////////////////////////////////////////////////////////////////////
+#define OBJ_PARSE_BLOCK (1<<20)     // bytes
+#define OBJ_PARSE_BATCH 4           // blocks for each worker in a batch
+
+static inline bool isBlank(char c) { return c==' ' || c=='\t' || c=='\r'; }
+static inline bool isDigit(char c) { return uint8_t(c-'0') < 10; }
+
+//  Locale independent: decimal mantissa (19 digits) scaled in double
+//  returns end of token or nullptr if no token before end
+static const char *parseFloat(const char *s, const char *end, float &val)
+{
+    static const double pow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    while(s<end && isBlank(*s)) s++;
+    if(s==end) return nullptr;
+
+    const bool neg = *s=='-';
+    if(*s=='-' || *s=='+') s++;
+
+    uint64_t m = 0;
+    int exp = 0, nDigits = 0;
+    const char *start = s;
+    for(; s<end && isDigit(*s); s++)
+        if(nDigits<19) { m = m*10 + uint8_t(*s-'0'); nDigits += m!=0; } else exp++;
+    if(s<end && *s=='.')
+        for(s++; s<end && isDigit(*s); s++)
+            if(nDigits<19) { m = m*10 + uint8_t(*s-'0'); nDigits += m!=0; exp--; }
+
+    if(s==start) {      // inf, nan or garbage
+        while(s<end && !isBlank(*s)) s++;
+        val = (s-start>=3 && (*start|0x20)=='i') ? (neg ? -INFINITY : INFINITY) : NAN;
+        return s;
+    }
 
-        const uint iCol = 0xff000000 | (uint(col.b*255.f) << 16) | (uint(col.g*255.f) << 8) | uint(col.r*255.f);
-        *ptr++ = glm::uintBitsToFloat( iCol );
-        //*ptr++ = glm::dot(lum, col);
+    if(s<end && (*s|0x20)=='e') {
+        const char *e = s+1;
+        const bool expNeg = e<end && *e=='-';
+        if(e<end && (*e=='-' || *e=='+')) e++;
+        if(e<end && isDigit(*e)) {
+            int x = 0;
+            for(; e<end && isDigit(*e); e++) if(x<10000) x = x*10 + (*e-'0');
+            exp += expNeg ? -x : x;
+            s = e;
+        }
+    }
 
-    }  
-    theWnd->getParticlesSystem()->getEmitter()->getVBO()->uploadSubBuffer(j,theWnd->getParticlesSystem()->getEmitter()->getSizeCircularBuffer());
+    double d = double(m);
+    if(m && exp) {
+        if(exp<0) d = exp>=-22 ? d / pow10[-exp] : d * std::pow(10., exp);
+        else      d = exp<= 22 ? d * pow10[ exp] : d * std::pow(10., exp);
+    }
+    val = float(neg ? -d : d);
+    return s;
+}
 
-    
-    //theWnd->getParticlesSystem()->getEmitter()->getVBO()->unmapBuffer(nVtx);
+//  Tokens of a vertex line: xyz, then w from speed token or from rgb, packed
+//  as rendered for loaded data
+#define TEXT_MAX_TOKENS 16
 
-    return true;
+struct textVertexLayout {
+    int nTokens = 6;
+    int xyz[3] = { 0, 1, 2 };
+    int speed = -1;
+    int rgb[3] = { 3, 4, 5 };       // rgb[0]<0: w is speed token (or 0)
+    float rgbScale = 1.f;           // rgb tokens to [0,1]
+};
+
+//  rgb in [0,1] to w of loaded data
+static inline float packedColor(const vec3 &col)
+{
+    const uint iCol = 0xff000000 | (uint(col.b*255.f) << 16) | (uint(col.g*255.f) << 8) | uint(col.r*255.f);
+    return glm::uintBitsToFloat( iCol );
 }
 
+//  rgb are bits of w: lost in packed vertex formats (half or unorm16 w)
+static bool checkColorImport(const char *fileName, const textVertexLayout &layout)
+{
+    if(layout.rgb[0]<0 || !theWnd->getParticlesSystem()->getEmitter()->getPacking().isPacked()) return true;
+    cout << fileName << ": rgb colors need float vertex format" << endl;
+    return false;
+}
 
+//  Not blank lines in [s, end): same rule of parseTextLines
+static GLuint countTextLines(const char *s, const char *end)
+{
+    GLuint count = 0;
+    while(s<end) {
+        const char *eol = (const char *) memchr(s, '\n', end-s);
+        if(!eol) eol = end;
+        while(s<eol && isBlank(*s)) s++;
+        if(s<eol) count++;
+        s = eol+1;
+    }
+    return count;
+}
 
-bool loadAttractorFile(bool fileImport, const char *file)  
-{
-
-    //theWnd->getParticlesSystem()->getEmitter()->setEmitterOff();
-    attractorsList.getThreadStep()->stopThread();
+//  Up to n vertices from lines in [s, end): missing values are 0, or 1 for rgb
+static GLuint parseTextLines(const char *s, const char *end, float *dst, GLuint n, const textVertexLayout &layout)
+{
+    const bool hasColor = layout.rgb[0]>=0;
+    GLuint count = 0;
+    while(s<end && count<n) {
+        const char *eol = (const char *) memchr(s, '\n', end-s);
+        if(!eol) eol = end;
+        while(s<eol && isBlank(*s)) s++;
+        if(s<eol) {
+            float v[TEXT_MAX_TOKENS] = {};
+            if(hasColor) for(int i=0; i<3; i++) v[layout.rgb[i]] = 1.f/layout.rgbScale;
+            for(int i=0; i<layout.nTokens && s; i++) s = parseFloat(s, eol, v[i]);
+
+            *dst++ = v[layout.xyz[0]];
+            *dst++ = v[layout.xyz[1]];
+            *dst++ = v[layout.xyz[2]];
+            *dst++ = hasColor ? packedColor(vec3(v[layout.rgb[0]], v[layout.rgb[1]], v[layout.rgb[2]]) * layout.rgbScale) :
+                                (layout.speed>=0 ? v[layout.speed] : 0.f);
+            count++;
+        }
+        s = eol+1;
+    }
+    return count;
+}
 
-    char const * patterns[] = { "*.chatt", "*.sca" };           
-    char const * fileName = (file == nullptr) ? 
-                            theApp->openFile(theApp->getLastFile().size() ? theApp->getLastFile().c_str() : STRATT_PATH, patterns, 2) :
-                            file;
-
-    if(fileName==nullptr) {
-        theWnd->getParticlesSystem()->getEmitter()->setEmitterOn();
-        return false;
-    }
-
-    theApp->setLastFile(fileName);
-
-    if(fileImport) {
-        attractorsList.loadFile(fileName); 
-    }
-    else  {
-        if(theApp->loadAttractor(fileName))
-            attractorsList.setFileName(fileName);
-
-                
-    }
-    attractorsList.getThreadStep()->restartEmitter();
-    attractorsList.get()->initStep();
-    attractorsList.getThreadStep()->startThread();
-
-    //theWnd->getParticlesSystem()->getEmitter()->setEmitterOn();
-
-    return true;
-}
-
-void saveAttractorFile(bool fileExport)  
-{
-
-    attractorsList.getThreadStep()->stopThread();
-
-    char const * patterns[] = { "*.chatt", "*.sca" };        
-    char const * fileName = theApp->saveFile(theApp->getLastFile().size() ? theApp->getLastFile().c_str() : STRATT_PATH, patterns, 2);
-
-    if(fileName!=nullptr) {
-    
-        theApp->setLastFile(fileName);
-
-        if(fileExport) { 
-            attractorsList.saveFile(fileName); 
-            //attractorsList.get()->saveVals(fileName);
-        }
-        else {
-            theApp->saveAttractor(fileName);
-        }
-    }
-
-    attractorsList.getThreadStep()->restartEmitter();
-    attractorsList.get()->initStep();
-    attractorsList.getThreadStep()->startThread();
-}
+//  Blocks [0, usedBlocks) of vertices [first[b], first[b+1]) clamped to count
+//  decoded by nThreads workers (decode(b, dst, n): n float4) straight in
+//  their slice of a double buffered staging, uploaded by render thread while
+//  next batch is decoded
+template <class Decode>
+static void uploadBlocks(emitterBaseClass *emitter, GLuint count, const vector<uint64_t> &first, int usedBlocks, int nThreads, Decode decode)
+{
+    auto blockSize = [&](int b) { return GLuint(std::min(first[b+1], uint64_t(count)) - first[b]); };
+
+    // packed formats: decoded in float and packed (unorm16 keeps the current box)
+    const vertexPacking &packing = emitter->getPacking();
+    const GLuint bytesPerVertex = packing.getBytesPerVertex();
+
+    const int batchBlocks = nThreads * OBJ_PARSE_BATCH;
+    const int nBatches = (usedBlocks + batchBlocks-1) / batchBlocks;
+    GLuint maxBatch = 0;
+    for(int b=0; b<usedBlocks; b+=batchBlocks)
+        maxBatch = std::max(maxBatch, GLuint(std::min(first[std::min(b+batchBlocks, usedBlocks)], uint64_t(count)) - first[b]));
+
+    resetEmitterForImport(emitter, count);
+
+    vector<uint8_t> staging[2] = { vector<uint8_t>(size_t(maxBatch) * bytesPerVertex), vector<uint8_t>(size_t(maxBatch) * bytesPerVertex) };
+    int decoded[2] = { 0, 0 }, uploadedBatches = 0;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<int> next(0);
+
+    // a block waits its staging buffer, uploaded two batches before
+    auto worker = [&] {
+        vector<float> unpacked;
+        for(int b; (b = next++) < usedBlocks; ) {
+            const int batch = b / batchBlocks;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [&] { return batch < uploadedBatches + 2; });
+            }
+            const GLuint n = blockSize(b);
+            uint8_t *dst = staging[batch&1].data() + size_t(first[b] - first[batch*batchBlocks]) * bytesPerVertex;
+            if(packing.isPacked()) {
+                unpacked.resize(size_t(n)*4);
+                decode(b, unpacked.data(), n);
+                packing.pack(unpacked.data(), dst, n);
+            } else 
+                decode(b, (float *) dst, n);
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                decoded[batch&1]++;
+            }
+            cv.notify_all();
+        }
+    };
+    vector<thread> workers;
+    for(int i=0; i<nThreads; i++) workers.emplace_back(worker);
+
+    for(int batch=0; batch<nBatches; batch++) {
+        const int b0 = batch*batchBlocks, b1 = std::min(b0 + batchBlocks, usedBlocks);
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return decoded[batch&1] == b1-b0; });
+        }
+        emitter->getVBO()->uploadVertices(staging[batch&1].data(), GLuint(std::min(first[b1], uint64_t(count)) - first[b0]), count);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            decoded[batch&1] = 0;
+            uploadedBatches++;
+        }
+        cv.notify_all();
+    }
+    for(auto &w : workers) w.join();
+}
 
+//  nVtx vertex lines in [body, end) to emitter: returns vertices imported
+static GLuint importTextVertices(const char *body, const char *end, uint64_t nVtx, const textVertexLayout &layout)
+{
+    // chunks start at first line after each OBJ_PARSE_BLOCK boundary
+    vector<const char *> blocks(1, body);
+    for(const char *p = body + OBJ_PARSE_BLOCK; p < end; p += OBJ_PARSE_BLOCK) {
+        p = std::max(p, blocks.back()+1);       // lines longer than a block
+        const char *nl = (const char *) memchr(p-1, '\n', end-(p-1));
+        if(!nl || nl+1 >= end) break;
+        blocks.push_back(nl+1);
+    }
+    blocks.push_back(end);
+    const int nBlocks = int(blocks.size()) - 1;
+
+    // render thread uploads
+    const int nThreads = std::max(int(std::thread::hardware_concurrency())-1, 1);
+
+    // first vertex of each block
+    vector<uint64_t> first(nBlocks+1, 0);
+    {
+        std::atomic<int> next(0);
+        auto counter = [&] { for(int b; (b = next++) < nBlocks; ) first[b+1] = countTextLines(blocks[b], blocks[b+1]); };
+        vector<thread> workers;
+        for(int i=1; i<nThreads; i++) workers.emplace_back(counter);
+        counter();
+        for(auto &w : workers) w.join();
+    }
+    for(int b=0; b<nBlocks; b++) first[b+1] += first[b];
 
-//  Attractor with scalarK general files
-////////////////////////////////////////////////////////////////////////////
+    emitterBaseClass *emitter = theWnd->getParticlesSystem()->getEmitter();
+    const GLuint count = GLuint(std::min(std::min(nVtx, first[nBlocks]), uint64_t(emitter->getSizeAllocatedBuffer())));
+    if(!count) return 0;
 
-void AttractorBase::saveVals(Config &cfg) 
-{
-    vector<float> v((vVal.size()*3));
+    int usedBlocks = 0;
+    while(usedBlocks<nBlocks && first[usedBlocks]<count) usedBlocks++;
 
-    memcpy(v.data(), vVal.data(), vVal.size()*sizeof(glm::vec3));
+    uploadBlocks(emitter, count, first, usedBlocks, nThreads, 
+                 [&](int b, float *dst, GLuint n) { parseTextLines(blocks[b], blocks[b+1], dst, n, layout); });
 
-    cfg["Name"] = getNameID();
-    saveAdditionalData(cfg);
-    cfg["kMax" ] = kMax;
-    cfg["kMin" ] = kMin;
-    cfg["vMax" ] = vMax;
-    cfg["vMin" ] = vMin;
-    cfg["vData"] = Config::array(v);
-    saveKVals(cfg);
+    return count;
 }
 
-void AttractorBase::loadVals(Config &cfg) 
+bool importObjFile(const char *fileName)
 {
-    kMax = cfg.get_or("kMax", kMax);
-    kMin = cfg.get_or("kMin", kMin);
-    vMax = cfg.get_or("vMax", vMax);
-    vMin = cfg.get_or("vMin", vMin);
+    mappedFile file;
+    if(!file.open(fileName)) return false;
+
+    const char *text = (const char *) file.data(), *end = text + file.getSize();
+
+    // header: vertices count
+    const char *eol = (const char *) memchr(text, '\n', end-text);
+    const char *body = eol ? eol+1 : end;
+    uint64_t nVtx = 0;
+    for(const char *s = text; s<body && (isBlank(*s) || isDigit(*s)); s++) 
+        if(isDigit(*s)) nVtx = nVtx*10 + uint8_t(*s-'0');
+
+    textVertexLayout layout;
+    if(!checkColorImport(fileName, layout)) return false;
+    if(!importTextVertices(body, end, nVtx, layout)) {
+        cout << fileName << ": no vertices" << endl;
+        return false;
+    }
+    theWnd->getParticlesSystem()->getEmitter()->setColorData(true);
+    return true;
+}
 
-    loadAdditionalData(cfg);
 
-    vector<float> v;
-    for (const Config& e : cfg["vData"].as_array()) v.push_back(e.as_float());
+//  Points file (.chp): binary container of emitted points, native (little)
+//  endian: pointsFileHeader, then count vertices of bytesPerVertex bytes in
+//  vertexFormat (packed formats decoded as qMin + v * qScale)
+//  Import maps the file and uploads it in getSizeStepBuffer() chunks, w/o
+//  conversion if its format is the emitter one
+////////////////////////////////////////////////////////////////////////////
+#define POINTS_FILE_MAGIC "CHPT"
+#define POINTS_FILE_VERSION 1
+
+struct pointsFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+    uint32_t format, bytesPerVertex;
+    float qMin[4], qScale[4];
+    float bMin[4], bMax[4];         //bounds of xyz and speed
+};
+static_assert(sizeof(pointsFileHeader) == 88, "pointsFileHeader: no padding allowed");
+
+bool importPointsFile(const char *fileName)
+{
+    mappedFile file;
+    if(!file.open(fileName) || file.getSize() < sizeof(pointsFileHeader)) return false;
+
+    pointsFileHeader hdr;
+    memcpy(&hdr, file.data(), sizeof(hdr));
+
+    vertexPacking filePacking;
+    filePacking.format = hdr.format;
+    if(memcmp(hdr.magic, POINTS_FILE_MAGIC, 4) || hdr.version != POINTS_FILE_VERSION || 
+       hdr.format >= vtxFmtNum || hdr.bytesPerVertex != filePacking.getBytesPerVertex() ||
+       (file.getSize() - sizeof(hdr)) / hdr.bytesPerVertex < hdr.count) {
+        cout << fileName << ": not a valid points file" << endl;
+        return false;
+    }
+    filePacking.qMin = glm::make_vec4(hdr.qMin); filePacking.qScale = glm::make_vec4(hdr.qScale);
+
+    emitterBaseClass *emitter = theWnd->getParticlesSystem()->getEmitter();
+    vertexPacking &packing = emitter->getPacking();
+    const GLuint count = GLuint(std::min(hdr.count, uint64_t(emitter->getSizeAllocatedBuffer())));
+
+    // same format: raw upload (unorm16 box of the file), else decoded and packed
+    const bool raw = hdr.format == packing.format;
+    if(raw) { packing.qMin = filePacking.qMin; packing.qScale = filePacking.qScale; }
+    else packing.setBox(glm::make_vec4(hdr.bMin), glm::make_vec4(hdr.bMax));
+    emitter->cancelFit();
+
+    resetEmitterForImport(emitter, count);
+
+    const GLuint step = emitter->getSizeStepBuffer();
+    vector<float> unpacked(raw ? 0 : step*4);
+    vector<uint8_t> packed(raw || !packing.isPacked() ? 0 : step*packing.getBytesPerVertex());
+
+    const uint8_t *src = file.data() + sizeof(hdr);
+    for(GLuint i=0; i<count; i+=step) {
+        const GLuint n = std::min(step, count - i);
+        const uint8_t *p = src + uint64_t(i) * hdr.bytesPerVertex;
+        if(!raw) {
+            filePacking.unpack(p, unpacked.data(), n);
+            if(packing.isPacked()) { packing.pack(unpacked.data(), packed.data(), n); p = packed.data(); }
+            else p = (const uint8_t *) unpacked.data();
+        }
+        emitter->getVBO()->uploadVertices(p, n, count);
+    }
 
-    const int vSize = v.size()/3;
-    vVal.resize(vSize);
+    return true;
+}
 
-    memcpy(vVal.data(), v.data(), vSize*sizeof(glm::vec3));
+bool exportPointsFile(const char *fileName)
+{
+    emitterBaseClass *emitter = theWnd->getParticlesSystem()->getEmitter();
+    const vertexPacking &packing = emitter->getPacking();
+    vtxBUFFER *vbo = emitter->getVBO();
+
+    FILE *f = fopen(fileName, "wb");
+    if(f == nullptr) return false;
+
+    // whole circular buffer, in buffer order
+    const bool emitting = pauseEmitterForExport(emitter);
+    const GLuint szCircular = emitter->getSizeCircularBuffer();
+    const GLuint count = GLuint(std::min(vbo->getVertexUploaded(), GLuint64(szCircular)));
+
+    pointsFileHeader hdr = {};
+    memcpy(hdr.magic, POINTS_FILE_MAGIC, 4);
+    hdr.version = POINTS_FILE_VERSION;
+    hdr.count = count;
+    hdr.format = packing.format;
+    hdr.bytesPerVertex = packing.getBytesPerVertex();
+    memcpy(hdr.qMin, glm::value_ptr(packing.qMin), sizeof(hdr.qMin));
+    memcpy(hdr.qScale, glm::value_ptr(packing.qScale), sizeof(hdr.qScale));
+
+    // header rewritten w/ bounds at end
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+    const GLuint step = emitter->getSizeStepBuffer();
+    vector<uint8_t> buffer(size_t(step) * hdr.bytesPerVertex);
+    vector<float> unpacked(packing.isPacked() ? step*4 : 0);
+    vec4 vMin(FLT_MAX), vMax(-FLT_MAX);
+
+    for(GLuint i=0; ok && i<count; i+=step) {
+        const GLuint n = std::min(step, count - i);
+        vbo->readVertices(buffer.data(), i, n);
+
+        const float *pts = (const float *) buffer.data();
+        if(packing.isPacked()) { packing.unpack(buffer.data(), unpacked.data(), n); pts = unpacked.data(); }
+        for(GLuint j=0; j<n; j++) {
+            const vec4 v = glm::make_vec4(pts + j*4);
+            if(any(isnan(v)) || any(isinf(v))) continue;
+            vMin = min(vMin, v); vMax = max(vMax, v);
+        }
 
-    loadKVals(cfg);
+        ok = fwrite(buffer.data(), hdr.bytesPerVertex, n, f) == n;
+    }
+    attractorsList.getThreadStep()->startThread(emitting);
 
-    initStep();
+    if(vMin.x > vMax.x) vMin = vMax = vec4(0.f);
+    memcpy(hdr.bMin, glm::value_ptr(vMin), sizeof(hdr.bMin));
+    memcpy(hdr.bMax, glm::value_ptr(vMax), sizeof(hdr.bMax));
+    ok = ok && !fseek(f, 0, SEEK_SET) && fwrite(&hdr, sizeof(hdr), 1, f) == 1;
 
+    ok = !fclose(f) && ok;
+    if(!ok) cout << fileName << ": write error" << endl;
+    return ok;
 }
 
-//  Attractor with scalarK general files
-////////////////////////////////////////////////////////////////////////////
-void attractorScalarK::loadKVals(Config &cfg) 
+//  PLY (binary_little_endian / ascii): vertex element, must be the first one,
+//  with x y z and speed, or red green blue packed in w (as loaded data)
+//  Export reads a GPU snapshot of drawn vertices back in PLY_EXPORT_CHUNK
+//  chunks, one for each frame (never waits), and a background thread writes
+//  them: memory bound to PLY_EXPORT_CHUNKS chunks
+////////////////////////////////////////////////////////////////////////////
+#define PLY_MAX_HEADER (1<<16)
+#define PLY_EXPORT_CHUNK (1<<19)        // vertices
+#define PLY_EXPORT_CHUNKS 4
+#define PLY_WRITE_BATCH 4096            // vertices formatted for each fwrite
+#define PLY_ASCII_LINE 96
+
+enum plyType { plyInt8, plyUint8, plyInt16, plyUint16, plyInt32, plyUint32, plyFloat32, plyFloat64 };
+
+static const struct { const char *name, *alias; int size; } plyTypes[] = {
+    { "char",  "int8",   1 }, { "uchar",  "uint8",   1 }, 
+    { "short", "int16",  2 }, { "ushort", "uint16",  2 },
+    { "int",   "int32",  4 }, { "uint",   "uint32",  4 },
+    { "float", "float32",4 }, { "double", "float64", 8 } };
+
+struct plyVertexElement {
+    bool binary = false;
+    uint64_t count = 0;
+    const uint8_t *data = nullptr;      // first vertex
+    GLuint stride = 0;                  // binary
+    vector<int> type, offset;
+    textVertexLayout layout;            // property index of x y z, speed, rgb
+};
+
+static double plyValue(const uint8_t *p, int type)
 {
-    kVal.clear();
-    for (const Config& e : cfg["kData"].as_array()) kVal.push_back(e.as_float());
-    std::cout << kVal.size() << endl;
+    switch(type) {
+        case plyInt8   : return double(*(const int8_t *) p);
+        case plyUint8  : return double(*p);
+        case plyInt16  : { int16_t  v; memcpy(&v, p, 2); return v; }
+        case plyUint16 : { uint16_t v; memcpy(&v, p, 2); return v; }
+        case plyInt32  : { int32_t  v; memcpy(&v, p, 4); return v; }
+        case plyUint32 : { uint32_t v; memcpy(&v, p, 4); return v; }
+        case plyFloat32: { float    v; memcpy(&v, p, 4); return v; }
+        default        : { double   v; memcpy(&v, p, 8); return v; }
+    }
 }
 
-void attractorScalarK::saveKVals(Config &cfg) 
+static bool parsePlyHeader(const uint8_t *data, uint64_t size, plyVertexElement &vtx)
 {
-    cfg["kData"] = Config::array(kVal); 
+    const char *text = (const char *) data, *end = text + std::min(size, uint64_t(PLY_MAX_HEADER));
+    const char tag[] = "end_header";
+    const char *hdrEnd = std::search(text, end, tag, tag + sizeof(tag)-1);
+    if(size<4 || memcmp(text, "ply", 3) || hdrEnd == end) return false;
+    const char *eol = (const char *) memchr(hdrEnd, '\n', (text + size) - hdrEnd);
+    vtx.data = eol ? (const uint8_t *) eol+1 : data + size;
+
+    textVertexLayout &layout = vtx.layout;
+    layout.xyz[0] = layout.xyz[1] = layout.xyz[2] = layout.rgb[0] = layout.rgb[1] = layout.rgb[2] = -1;
+
+    bool hasFormat = false, inVertex = false;
+    std::istringstream hdr(string(text, hdrEnd));
+    for(string line; getline(hdr, line); ) {
+        std::istringstream tokens(line);
+        string key, type, name;
+        tokens >> key;
+        if(key == "format") {
+            tokens >> type;
+            if(type != "ascii" && type != "binary_little_endian") return false;
+            vtx.binary = type != "ascii";
+            hasFormat = true;
+        } else if(key == "element") {
+            if(inVertex) break;             // following elements are not read
+            tokens >> name >> vtx.count;
+            if(name != "vertex") return false;
+            inVertex = true;
+        } else if(key == "property" && inVertex) {
+            tokens >> type >> name;
+            int t = 0;
+            while(t<8 && type != plyTypes[t].name && type != plyTypes[t].alias) t++;
+            if(t == 8) return false;        // list or unknown type
+
+            const int idx = int(vtx.type.size());
+            vtx.type.push_back(t);
+            vtx.offset.push_back(vtx.stride);
+            vtx.stride += plyTypes[t].size;
+            if(idx >= TEXT_MAX_TOKENS) continue;
+            if(name == "x") layout.xyz[0] = idx;
+            else if(name == "y") layout.xyz[1] = idx;
+            else if(name == "z") layout.xyz[2] = idx;
+            else if(name == "speed") layout.speed = idx;
+            else if(name == "red"  ) { layout.rgb[0] = idx; layout.rgbScale = t < plyFloat32 ? 1.f/255.f : 1.f; }
+            else if(name == "green") layout.rgb[1] = idx;
+            else if(name == "blue" ) layout.rgb[2] = idx;
+        }
+    }
+    layout.nTokens = std::min(int(vtx.type.size()), TEXT_MAX_TOKENS);
+    if(layout.rgb[1]<0 || layout.rgb[2]<0) layout.rgb[0] = -1;
+
+    return hasFormat && inVertex && layout.xyz[0]>=0 && layout.xyz[1]>=0 && layout.xyz[2]>=0;
 }
-//  Attractor with vectorK general files
-////////////////////////////////////////////////////////////////////////////
-void attractorVectorK::loadKVals(Config &cfg) 
+
+static void decodePlyVertices(const plyVertexElement &vtx, const uint8_t *src, float *dst, GLuint n)
 {
-    vector<float> k;
+    const textVertexLayout &l = vtx.layout;
+    auto value = [&](const uint8_t *p, int i) { return i<0 ? 0.f : float(plyValue(p + vtx.offset[i], vtx.type[i])); };
+
+    for(GLuint j=0; j<n; j++, src += vtx.stride) {
+        *dst++ = value(src, l.xyz[0]);
+        *dst++ = value(src, l.xyz[1]);
+        *dst++ = value(src, l.xyz[2]);
+        *dst++ = l.rgb[0]>=0 ? packedColor(vec3(value(src, l.rgb[0]), value(src, l.rgb[1]), value(src, l.rgb[2])) * l.rgbScale) : 
+                               value(src, l.speed);
+    }
+}
 
-    for (const Config& e : cfg["kData"].as_array()) k.push_back(e.as_float());
+bool importPlyFile(const char *fileName)
+{
+    mappedFile file;
+    plyVertexElement vtx;
+    if(!file.open(fileName) || !parsePlyHeader(file.data(), file.getSize(), vtx)) {
+        cout << fileName << ": not a supported PLY file" << endl;
+        return false;
+    }
+    const uint8_t *end = file.data() + file.getSize();
+    if(!checkColorImport(fileName, vtx.layout)) return false;
+    emitterBaseClass *emitter = theWnd->getParticlesSystem()->getEmitter();
 
-    const int kSize = k.size()/3;
+    if(!vtx.binary) {
+        if(importTextVertices((const char *) vtx.data, (const char *) end, vtx.count, vtx.layout)) {
+            emitter->setColorData(vtx.layout.rgb[0]>=0);
+            return true;
+        }
+        cout << fileName << ": no vertices" << endl;
+        return false;
+    }
 
-    kVal.resize(kSize);
+    const GLuint count = GLuint(std::min(std::min(vtx.count, uint64_t(end - vtx.data) / vtx.stride), uint64_t(emitter->getSizeAllocatedBuffer())));
+    if(!count) {
+        cout << fileName << ": no vertices" << endl;
+        return false;
+    }
 
-    memcpy(kVal.data(), k.data(), kSize*sizeof(glm::vec3));
+    // x y z speed float: same layout of float vertices
+    const textVertexLayout &l = vtx.layout;
+    const bool asFloat4 = vtx.stride == 4*sizeof(float) && l.xyz[0]==0 && l.xyz[1]==1 && l.xyz[2]==2 && l.speed==3 && l.rgb[0]<0 &&
+                          vtx.type[0]==plyFloat32 && vtx.type[1]==plyFloat32 && vtx.type[2]==plyFloat32 && vtx.type[3]==plyFloat32;
+
+    // packed formats: decoded in float and packed (unorm16 keeps the attractor box)
+    const vertexPacking &packing = emitter->getPacking();
+    resetEmitterForImport(emitter, count);
+
+    const GLuint step = emitter->getSizeStepBuffer();
+    vector<float> unpacked(step*4);
+    vector<uint8_t> packed(packing.isPacked() ? step*packing.getBytesPerVertex() : 0);
+
+    for(GLuint i=0; i<count; i+=step) {
+        const GLuint n = std::min(step, count - i);
+        const uint8_t *src = vtx.data + uint64_t(i) * vtx.stride;
+        const float *pts = (const float *) src;
+        if(!asFloat4) { decodePlyVertices(vtx, src, unpacked.data(), n); pts = unpacked.data(); }
+        if(packing.isPacked()) {
+            packing.pack(pts, packed.data(), n);
+            emitter->getVBO()->uploadVertices(packed.data(), n, count);
+        } else 
+            emitter->getVBO()->uploadVertices(pts, n, count);
+    }
+    emitter->setColorData(l.rgb[0]>=0);
 
+    return true;
 }
 
-void attractorVectorK::saveKVals(Config &cfg) 
+class plyExportClass
 {
-vector<float>  k((kVal.size()*3));
+public:
+    ~plyExportClass() {
+        if(!writerThread) return;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            failed = true;
+        }
+        cv.notify_all();
+        writerThread->join();
+        delete writerThread;
+    }
 
-    memcpy(k.data(), kVal.data(), kVal.size()*sizeof(glm::vec3));
+    bool start(const char *fileName, bool binaryFmt, bool rgbFromW);
+    void update();
+    float getProgress() { return writerThread ? float(written) / float(count) : -1.f; }
+
+private:
+    void writer();
+    bool writeHeader();
+    bool writeChunk(const float *pts, GLuint n);
+
+    snapshotBuffer snapshot;
+    vertexPacking packing;
+    bool binary = true, colorW = false;
+    FILE *file = nullptr;
+    thread *writerThread = nullptr;
+
+    GLuint count = 0, readVtx = 0;              // render loop
+    std::atomic<GLuint> written { 0 };
+    std::atomic<bool> done { false };
+
+    vector<uint8_t> chunks[PLY_EXPORT_CHUNKS];
+    vector<char> out;                           // writer
+    GLuint chunkSize[PLY_EXPORT_CHUNKS];
+    std::deque<int> freeChunks, filledChunks;
+    bool failed = false;
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+
+bool plyExportClass::start(const char *fileName, bool binaryFmt, bool rgbFromW)
+{
+    if(writerThread) return false;
 
-    cfg["kData"] = Config::array(k); 
+    emitterBaseClass *emitter = theWnd->getParticlesSystem()->getEmitter();
+    count = snapshot.create(emitter->getVBO(), emitter->getSizeCircularBuffer());
+    if(!count) {
+        cout << fileName << ": no vertices or out of GPU memory" << endl;
+        return false;
+    }
+    file = fopen(fileName, "wb");
+    if(file == nullptr) {
+        snapshot.release();
+        return false;
+    }
+
+    packing = emitter->getPacking();
+    binary = binaryFmt; colorW = rgbFromW;
+    readVtx = 0; written = 0; done = false; failed = false;
+    freeChunks.clear(); filledChunks.clear();
+    for(int i=0; i<PLY_EXPORT_CHUNKS; i++) {
+        chunks[i].resize(size_t(PLY_EXPORT_CHUNK) * snapshot.getBytesPerVertex());
+        freeChunks.push_back(i);
+    }
+
+    writerThread = new thread(&plyExportClass::writer, this);
+    return true;
 }
-
-//  PowerN3D Attractor
-////////////////////////////////////////////////////////////////////////////
-void PowerN3D::saveAdditionalData(Config &cfg) 
+
+//  render loop, each frame: at most one chunk read back
+void plyExportClass::update()
 {
-    cfg["Order" ] = order;
+    if(!writerThread) return;
+
+    if(readVtx<count && snapshot.isReady()) {
+        int chunk = -1;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(!failed && !freeChunks.empty()) { chunk = freeChunks.front(); freeChunks.pop_front(); }
+        }
+        if(chunk>=0) {
+            chunkSize[chunk] = std::min(GLuint(PLY_EXPORT_CHUNK), count - readVtx);
+            snapshot.read(chunks[chunk].data(), readVtx, chunkSize[chunk]);
+            readVtx += chunkSize[chunk];
+            if(readVtx == count) snapshot.release();
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                filledChunks.push_back(chunk);
+            }
+            cv.notify_one();
+        }
+    }
+
+    if(done) {
+        writerThread->join();
+        delete writerThread;
+        writerThread = nullptr;
+        snapshot.release();
+        for(auto &c : chunks) vector<uint8_t>().swap(c);
+    }
 }
 
-void PowerN3D::loadAdditionalData(Config &cfg) 
+void plyExportClass::writer()
 {
-    tmpOrder = order= cfg.get_or("Order",order);
-/*
-    nCoeff = getNumCoeff();
-    const int kSize = k.size()/3;
-
-    if(nCoeff!=kSize || v.size()!=3) assert("mismatch loaded size!!");
+    bool ok = writeHeader();
+    vector<float> unpacked(packing.isPacked() ? PLY_EXPORT_CHUNK*4 : 0);
+    out.resize(PLY_WRITE_BATCH * PLY_ASCII_LINE);
+
+    while(ok && written < count) {
+        int chunk;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return failed || !filledChunks.empty(); });
+            if(failed) break;
+            chunk = filledChunks.front(); filledChunks.pop_front();
+        }
+        const GLuint n = chunkSize[chunk];
+        const float *pts = (const float *) chunks[chunk].data();
+        if(packing.isPacked()) { packing.unpack(pts, unpacked.data(), n); pts = unpacked.data(); }
+
+        ok = writeChunk(pts, n);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            freeChunks.push_back(chunk);
+        }
+        written += n;
+    }
 
-    resizeBuffers();
-    ResetCurrent();
+    ok = !fclose(file) && ok;
+    file = nullptr;
+    vector<char>().swap(out);
+    if(!ok) {
+        cout << "PLY export: write error" << endl;
+        std::lock_guard<std::mutex> lock(mtx);
+        failed = true;
+    }
+    done = true;
+}
 
-    memcpy(vVal.data(), v.data(), sizeof(glm::vec3));
-    memcpy(kVal.data(), k.data(), kSize*sizeof(glm::vec3));
-*/
+bool plyExportClass::writeHeader()
+{
+    return fprintf(file, "ply\nformat %s 1.0\ncomment glChAoS.P points\nelement vertex %u\n"
+                         "property float x\nproperty float y\nproperty float z\n%send_header\n",
+                         binary ? "binary_little_endian" : "ascii", count,
+                         colorW ? "property uchar red\nproperty uchar green\nproperty uchar blue\n" : "property float speed\n") > 0;
 }
 
-void PowerN3D::saveVals(const char *name) 
+bool plyExportClass::writeChunk(const float *pts, GLuint n)
 {
-    ofstream ofs(name);
-    ofs.precision(15);
+    // float vertices: already x y z speed
+    if(binary && !colorW) return fwrite(pts, 4*sizeof(float), n, file) == n;
+
+    for(GLuint i=0; i<n; i+=PLY_WRITE_BATCH) {
+        char *o = out.data();
+        for(const float *p = pts + i*4, *pEnd = pts + std::min(i + PLY_WRITE_BATCH, n)*4; p<pEnd; p+=4) {
+            const uint col = glm::floatBitsToUint(p[3]);
+            if(binary) {
+                memcpy(o, p, 3*sizeof(float)); o += 3*sizeof(float);
+                *o++ = char(col & 0xff); *o++ = char((col >> 8) & 0xff); *o++ = char((col >> 16) & 0xff);
+            } else if(colorW)
+                o += snprintf(o, PLY_ASCII_LINE, "%.9g %.9g %.9g %u %u %u\n", p[0], p[1], p[2], col & 0xff, (col >> 8) & 0xff, (col >> 16) & 0xff);
+            else 
+                o += snprintf(o, PLY_ASCII_LINE, "%.9g %.9g %.9g %.9g\n", p[0], p[1], p[2], p[3]);
+        }
+        if(fwrite(out.data(), 1, o-out.data(), file) != size_t(o-out.data())) return false;
+    }
+    return true;
+}
 
-    const int nMagnets = kVal.size();
+static plyExportClass plyExport;
 
-    ofs << order << endl;
-    ofs << nMagnets << endl;
+bool exportPlyFile(const char *fileName, bool binary, bool colorW) { return plyExport.start(fileName, binary, colorW); }
+void updatePlyExport() { plyExport.update(); }
+float getPlyExportProgress() { return plyExport.getProgress(); }
 
-    ofs <<  vVal[0].x << " " << vVal[0].y << " " << vVal[0].z << endl;
-        
-    for(int i=0; i<nMagnets; i++) {
-        ofs <<  kVal[i].x << " " << kVal[i].y << " " << kVal[i].z << endl;
+//  Points archive (.cpz): quantized and compressed points (pointsArchiveWriter)
+//  Import decodes the independent blocks in parallel straight in upload
+//  staging, unorm16 box from bounds in footer; export reads the circular
+//  buffer back in getSizeStepBuffer() chunks (unorm16: quantized in its box)
+////////////////////////////////////////////////////////////////////////////
+bool importArchiveFile(const char *fileName)
+{
+    mappedFile file;
+    pointsArchiveReader archive;
+    if(!file.open(fileName) || !archive.open(file.data(), file.getSize())) {
+        cout << fileName << ": not a valid points archive" << endl;
+        return false;
+    }
+
+    emitterBaseClass *emitter = theWnd->getParticlesSystem()->getEmitter();
+    const GLuint count = GLuint(std::min(archive.getCount(), uint64_t(emitter->getSizeAllocatedBuffer())));
+    if(!count) {
+        cout << fileName << ": no vertices" << endl;
+        return false;
     }
-    cout << endl;
+
+    emitter->getPacking().setBox(archive.getBoundsMin(), archive.getBoundsMax());
+    emitter->cancelFit();
+
+    const int nBlocks = archive.getNumBlocks();
+    vector<uint64_t> first(nBlocks+1);
+    for(int b=0; b<=nBlocks; b++) first[b] = std::min(archive.getBlockFirst(b), archive.getCount());
+    int usedBlocks = 0;
+    while(usedBlocks<nBlocks && first[usedBlocks]<count) usedBlocks++;
+
+    // corrupted blocks are zeroed
+    std::atomic<bool> corrupted(false);
+    const int nThreads = std::max(int(std::thread::hardware_concurrency())-1, 1);
+    uploadBlocks(emitter, count, first, usedBlocks, nThreads, [&](int b, float *dst, GLuint n) {
+        if(!archive.decodeBlock(b, dst, n)) { memset(dst, 0, size_t(n)*4*sizeof(float)); corrupted = true; }
+    });
+
+    if(corrupted) cout << fileName << ": corrupted blocks" << endl;
+    return true;
 }
-void PowerN3D::loadVals(const char *name) 
+
+bool exportArchiveFile(const char *fileName, float relError)
 {
-    ifstream ifs(name);
-    ifs.precision(15);
-        
-    ifs >> order;
-    //nCoeff = getNumCoeff();
-    ifs >> nCoeff;
+    emitterBaseClass *emitter = theWnd->getParticlesSystem()->getEmitter();
+    const vertexPacking &packing = emitter->getPacking();
+    vtxBUFFER *vbo = emitter->getVBO();
+
+    // w is quantized as a number: rgb bits would be lost
+    if(emitter->hasColorData()) {
+        cout << fileName << ": rgb colors can't be archived (PLY export keeps them)" << endl;
+        return false;
+    }
+
+    FILE *f = fopen(fileName, "wb");
+    if(f == nullptr) return false;
+
+    // whole circular buffer, in buffer order
+    const bool emitting = pauseEmitterForExport(emitter);
+    const GLuint szCircular = emitter->getSizeCircularBuffer();
+    const GLuint count = GLuint(std::min(vbo->getVertexUploaded(), GLuint64(szCircular)));
 
-    resetData();
-    resetQueue();
+    pointsArchiveWriter archive;
+    bool ok = archive.open(f, relError);
+    if(packing.format == vtxFmtUnorm16) archive.setBox(packing.qMin, packing.qMin + packing.qScale);
 
+    const GLuint step = emitter->getSizeStepBuffer();
+    vector<uint8_t> buffer(size_t(step) * packing.getBytesPerVertex());
+    vector<float> unpacked(packing.isPacked() ? step*4 : 0);
 
-    ifs >>  vVal[0].x >> vVal[0].y >> vVal[0].z;
-        
-    for(int i=0; i<nCoeff; i++) {
-        ifs >>  kVal[i].x >> kVal[i].y >> kVal[i].z;
-    }  
+    for(GLuint i=0; ok && i<count; i+=step) {
+        const GLuint n = std::min(step, count - i);
+        vbo->readVertices(buffer.data(), i, n);
 
-    
+        const float *pts = (const float *) buffer.data();
+        if(packing.isPacked()) { packing.unpack(buffer.data(), unpacked.data(), n); pts = unpacked.data(); }
+        ok = archive.write(pts, n);
+    }
+    attractorsList.getThreadStep()->startThread(emitting);
+    ok = ok && archive.close();
+
+    ok = !fclose(f) && ok;
+    if(!ok) cout << fileName << ": write error" << endl;
+    return ok;
 }
 
+bool loadObjFile() 
+{  
+    attractorsList.getThreadStep()->stopThread();
+    char const * patterns[] = { "*.obj", "*.sca" };           
+    char const * fileName = theApp->openFile(nullptr, patterns, 2);
+
+    if(fileName==nullptr) return false;
 
-void attractorDtType::saveAdditionalData(Config &cfg)
-{
-        cfg["dtInc"] = dtStepInc;
+    return importObjFile(fileName);
 }
-void attractorDtType::loadAdditionalData(Config &cfg) 
+
+bool loadPointsFile()
 {
-    dtStepInc = cfg.get_or("dtInc",dtStepInc);
+    attractorsList.getThreadStep()->stopThread();
+    char const * patterns[] = { "*.chp" };
+    char const * fileName = theApp->openFile(nullptr, patterns, 1);
 
+    if(fileName==nullptr) return false;
 
+    return importPointsFile(fileName);
 }
 
+bool savePointsFile()
+{
+    char const * patterns[] = { "*.chp" };
+    char const * fileName = theApp->saveFile(nullptr, patterns, 1);
 
+    if(fileName==nullptr) return false;
 
+    return exportPointsFile(fileName);
+}
 
 
-
-//  Magnetic Attractor
-////////////////////////////////////////////////////////////////////////////
-void Magnetic::saveAdditionalData(Config &cfg) 
+bool loadPlyFile()
 {
-        cfg["nMagnets"] = vVal.size();    
+    attractorsList.getThreadStep()->stopThread();
+    char const * patterns[] = { "*.ply" };
+    char const * fileName = theApp->openFile(nullptr, patterns, 1);
+
+    if(fileName==nullptr) return false;
+
+    return importPlyFile(fileName);
 }
-void Magnetic::loadAdditionalData(Config &cfg) 
+
+bool savePlyFile(bool binary, bool colorW)
 {
-        tmpElements = nElements = cfg.get_or("nMagnets",2);
+    if(getPlyExportProgress() >= 0.f) return false;
+    char const * patterns[] = { "*.ply" };
+    char const * fileName = theApp->saveFile(nullptr, patterns, 1);
+
+    if(fileName==nullptr) return false;
+
+    return exportPlyFile(fileName, binary, colorW);
 }
 
-void loadAdditionalData(Config &cfg) {};
-
-void Magnetic::saveVals(const char *name) 
+bool loadArchiveFile()
 {
-    ofstream ofs(name);
-    ofs.precision(15);
+    attractorsList.getThreadStep()->stopThread();
+    char const * patterns[] = { "*.cpz" };
+    char const * fileName = theApp->openFile(nullptr, patterns, 1);
 
-    const int nMagnets = vVal.size();
+    if(fileName==nullptr) return false;
 
-    ofs << nMagnets << endl;
-        
-    for(int i=0; i<nMagnets; i++) {
-        ofs <<  kVal[i].x << " " << kVal[i].y << " " << kVal[i].z << endl;
-        ofs <<  vVal[i].x << " " << vVal[i].y << " " << vVal[i].z << endl;
-    }
-    cout << endl;
+    return importArchiveFile(fileName);
 }
 
+bool saveArchiveFile(float relError)
+{
+    char const * patterns[] = { "*.cpz" };
+    char const * fileName = theApp->saveFile(nullptr, patterns, 1);
 
-void Magnetic::loadVals(const char *name) 
-{  
-    //string line;         
-
-    ifstream ifs(name);
-    ifs.precision(15);
-        
-    int nMagnets;;
-    ifs >> nMagnets;
+    if(fileName==nullptr) return false;
 
-    resetQueue();
-    //ResizeVectors();        
-    kVal.resize(nMagnets);
-    vVal.resize(nMagnets);       
+    return exportArchiveFile(fileName, relError);
+}
 
-        
-    for(int i=0; i<nMagnets; i++) {
-        ifs >>  kVal[i].x >> kVal[i].y >> kVal[i].z;
-        ifs >>  vVal[i].x >> vVal[i].y >> vVal[i].z;
-    }  
+bool loadAttractorFile(bool fileImport, const char *file)  
+{
+
+    //theWnd->getParticlesSystem()->getEmitter()->setEmitterOff();
+    attractorsList.getThreadStep()->stopThread();
 
-    
+    char const * patterns[] = { "*.chatt", "*.sca" };           
+    char const * fileName = (file == nullptr) ? 
+                            theApp->openFile(theApp->getLastFile().size() ? theApp->getLastFile().c_str() : STRATT_PATH, patterns, 2) :
+                            file;
+
+    if(fileName==nullptr) {
+        theWnd->getParticlesSystem()->getEmitter()->setEmitterOn();
+        return false;
+    }
+
+    theApp->setLastFile(fileName);
+
+    if(fileImport) {
+        attractorsList.loadFile(fileName); 
+    }
+    else  {
+        if(theApp->loadAttractor(fileName))
+            attractorsList.setFileName(fileName);
+
+                
+    }
+    attractorsList.getThreadStep()->restartEmitter();
+    attractorsList.get()->initStep();
+    attractorsList.getThreadStep()->startThread();
+
+    //theWnd->getParticlesSystem()->getEmitter()->setEmitterOn();
+
+    return true;
+}
+
+void saveAttractorFile(bool fileExport)  
+{
+
+    attractorsList.getThreadStep()->stopThread();
+
+    char const * patterns[] = { "*.chatt", "*.sca" };        
+    char const * fileName = theApp->saveFile(theApp->getLastFile().size() ? theApp->getLastFile().c_str() : STRATT_PATH, patterns, 2);
+
+    if(fileName!=nullptr) {
+    
+        theApp->setLastFile(fileName);
+
+        if(fileExport) { 
+            attractorsList.saveFile(fileName); 
+            //attractorsList.get()->saveVals(fileName);
+        }
+        else {
+            theApp->saveAttractor(fileName);
+        }
+    }
+
+    attractorsList.getThreadStep()->restartEmitter();
+    attractorsList.get()->initStep();
+    attractorsList.getThreadStep()->startThread();
 }
 
-//  Attractor Continer Class
-////////////////////////////////////////////////////////////////////////////
+//  Attractor Continer Class: load and update view
+////////////////////////////////////////////////////////////////////////////
 bool AttractorsClass::loadVals(Config &cfg)
 {
+    cancelNewRandom();
     auto& c = cfg["Attractor"];
     if(c.has_key("Name")) {
-        int i = getSelectionByName((std::string)c.get_or("Name",""));
-        if(i>=0) {
-            selected = i;
-            get()->loadVals(c);            
+        if(loadSelected(c)) {
             theWnd->getParticlesSystem()->getTMat()->setView(get()->getPOV(),get()->getTGT());
             restart();
-            return true;
-            // NED INIT
         }
         return true;
     } 
     return false;
 }
 
-void AttractorsClass::saveFile(const char *name) 
-{
-    Config cfg = Config::object();
-
-    saveVals(cfg);
-
-    configuru::dump_file(name, cfg, configuru::JSON);
-}
-     
 bool AttractorsClass::loadFile(const char *name) 
 {
     Config cfg = configuru::parse_file(name, JSON);
     return loadVals(cfg);
 }
-
-void AttractorsClass::saveVals(Config &cfg)
-{
-    auto &a = cfg["Attractor"] = Config::object();
-    get()->saveVals(a);
-
-}
@@ -0,0 +1,175 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <cmath>
+#include <algorithm>
+
+//  Transcendental functions used by attractors Step, w/ selectable precision
+//
+//      attMath<attMathExact>   : libm float overloads (bit-identical to
+//                                plain sin/cos/... calls)
+//      attMath<attMathFast>    : polynomials, error ~ float rounding
+//      attMath<attMathFastest> : short polynomials, ~1e-4 error
+//
+//  Fast/Fastest are float-only and branch-free (selects only): loops over
+//  them are vectorized by compiler, as the multi-orbit lanes.
+//
+//  Measured max error vs double libm (inputs in domain):
+//                 Fast          Fastest
+//      sin/cos    2.7e-7 abs    1.2e-4 abs    |x| < 8192*pi
+//      asin/acos  4.1e-7 abs    6.8e-5 abs    |x| <= 1
+//      exp        1.3e-7 rel    1.0e-4 rel    
+//      pow(a,b)   1.3e-7 rel    8.4e-5 rel    a >= 0 finite, times (1+|b*log2(a)|)
+//
+//  Out of range: sin/cos lose accuracy (no NaN), exp/pow saturate in
+//  ~[2^-125, 2^127] (no 0 or inf), asin/acos return NaN as libm.
+////////////////////////////////////////////////////////////////////////////
+#if defined(__GNUC__)
+    #define ATT_MATH_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+    #define ATT_MATH_INLINE __forceinline
+#else
+    #define ATT_MATH_INLINE inline
+#endif
+
+enum attMathPrecision { attMathExact, attMathFast, attMathFastest };
+
+template <int PRECISION> struct attMath;
+
+template <> struct attMath<attMathExact>
+{
+    static float sin (float x) { return std::sin (x); }
+    static float cos (float x) { return std::cos (x); }
+    static float asin(float x) { return std::asin(x); }
+    static float acos(float x) { return std::acos(x); }
+    static float exp (float x) { return std::exp (x); }
+    static float pow (float a, float b) { return std::pow(a, b); }
+};
+
+template <int PRECISION> struct attMath
+{
+    ATT_MATH_INLINE static float sin(float x) {
+        const float q = roundToInt(x * float(M_1_PI));              // x = q*pi + r
+        return flipSign(sinPoly(reducePi(x, q)), int(q));           // (-1)^q * sin(r)
+    }
+    ATT_MATH_INLINE static float cos(float x) {
+        const float q = roundToInt(x * float(M_1_PI) - .5f);        // x = q*pi + pi/2 + r
+        return flipSign(sinPoly(reducePi(x, q + .5f)), int(q)+1);   // -(-1)^q * sin(r)
+    }
+
+    ATT_MATH_INLINE static float acos(float x) {
+        return float(M_PI_2) - asin(x);     // x < 0 : pi - acos(|x|), w/o select
+    }
+    ATT_MATH_INLINE static float asin(float x) {
+        return std::copysign(float(M_PI_2) - acosPoly(std::abs(x)), x);
+    }
+
+    ATT_MATH_INLINE static float exp(float x) {
+        const float xc = saturate(x, 88.7f);
+        const float n = roundToInt(xc * float(M_LOG2E));
+        const float f = ((xc - n*0.693145752f) - n*1.428606765e-6f) * float(M_LOG2E);  // x = n*ln2 + r
+        return pow2(n, f);
+    }
+    //a >= 0 only: log2(0) = -127
+    ATT_MATH_INLINE static float pow(float a, float b) {
+        return exp2(b * log2(a));
+    }
+
+private:
+    ATT_MATH_INLINE static uint32_t asUint(float f)  { uint32_t i; memcpy(&i, &f, sizeof(i)); return i; }
+    ATT_MATH_INLINE static float asFloat(uint32_t i) { float f; memcpy(&f, &i, sizeof(f)); return f; }
+
+    //|x| <= m w/ one select: clamp to constant bounds is folded by compiler
+    //in a 3-way branch, and loop is not vectorized
+    ATT_MATH_INLINE static float saturate(float x, float m) { return std::abs(x) < m ? x : std::copysign(m, x); }
+    //nearest integer, for |x| < 2^22
+    ATT_MATH_INLINE static float roundToInt(float x) { return (x + 12582912.f) - 12582912.f; }
+    //(-1)^n * x
+    ATT_MATH_INLINE static float flipSign(float x, int n) { return asFloat(asUint(x) ^ (uint32_t(n) << 31)); }
+
+    //x - q*pi, Cody-Waite: pi in 3 parts, first ones w/ few significant bits
+    ATT_MATH_INLINE static float reducePi(float x, float q) {
+        return ((x - q*3.140625f) - q*9.67502593994140625e-4f) - q*1.509957990978376432e-7f;
+    }
+
+    //sin(r), r in [-pi/2, pi/2]: minimax r + r^3*p(r^2)
+    ATT_MATH_INLINE static float sinPoly(float r) {
+        const float r2 = r*r;
+        return PRECISION == attMathFastest ?
+            r + r*r2*(-0.16607862f + r2*0.0076337720f) :
+            r + r*r2*(-0.16666657f + r2*(0.0083330173f + r2*(-1.9806615e-4f + r2*2.6000546e-6f)));
+    }
+
+    //acos(a), a in [0, 1]: Abramowitz & Stegun 4.4.45 / 4.4.46
+    ATT_MATH_INLINE static float acosPoly(float a) {
+        return std::sqrt(1.f - a) * (PRECISION == attMathFastest ?
+            1.5707288f + a*(-0.2121144f + a*(0.0742610f + a*-0.0187293f)) :
+            1.5707963050f + a*(-0.2145988016f + a*(0.0889789874f + a*(-0.0501743046f + 
+            a*(0.0308918810f + a*(-0.0170881256f + a*(0.0066700901f + a*-0.0012624911f)))))));
+    }
+
+    //2^y: same limits of exp
+    ATT_MATH_INLINE static float exp2(float y) {
+        const float yc = saturate(y, 128.f);
+        const float n = roundToInt(yc);
+        return pow2(n, yc - n);
+    }
+
+    //2^n * 2^f, n integer (saturated in [-125, 127]), f in [-.5, .5] minimax
+    ATT_MATH_INLINE static float pow2(float n, float f) {
+        const float p = PRECISION == attMathFastest ?
+            1.f + f*(0.69328293f + f*(0.24221097f + f*0.055008931f)) :
+            1.f + f*(0.69314720f + f*(0.24022648f + f*(0.055503325f + f*(0.0096184374f + 
+                  f*(0.0013398875f + f*1.5353362e-4f)))));
+        const int e = std::min(std::max(int(n), -125), 127);    // int min/max: no branches
+        return asFloat(asUint(p) + (uint32_t(e) << 23));
+    }
+
+    //log2(a), a > 0 normal: e + log2(m), m in [sqrt(.5), sqrt(2))
+    ATT_MATH_INLINE static float log2(float a) {
+        const uint32_t i = asUint(a);
+        const int32_t e = int32_t(i - 0x3f3504f3u) >> 23;
+        const float m = asFloat(i - (uint32_t(e) << 23));
+        const float t = (m - 1.f) / (m + 1.f), t2 = t*t;
+        return float(e) + t * (PRECISION == attMathFastest ?
+            2.8852286f + t2*0.98353456f :
+            2.8853913f + t2*(0.96147081f + t2*0.59897392f));
+    }
+};
@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+#pragma once
+
+#include <stdint.h>
+#include <random>
+
+//  Attractors random numbers: xoshiro128+ (floats from upper 24 bits),
+//  state expanded from a 32 bit seed w/ splitmix64
+//
+//      attRng()            : generator of calling thread, seeded from
+//                            random_device, reseeded by AttractorBase
+//                            for each candidate of random search
+//      attRandom::fill     : many values at once, ATT_RANDOM_LANES
+//                            independent streams (vectorized loop)
+//
+//  Same seed -> same sequence on all platforms (only integer ops).
+////////////////////////////////////////////////////////////////////////////
+#define ATT_RANDOM_LANES 8
+
+class attRandom
+{
+public:
+    attRandom() { seed(std::random_device()()); }
+    explicit attRandom(uint32_t s) { seed(s); }
+
+    void seed(uint32_t s) {
+        uint64_t z = s;
+        for(int i=0; i<4; i+=2) {
+            const uint64_t r = splitmix64(z);
+            st[i] = uint32_t(r); st[i+1] = uint32_t(r >> 32);
+        }
+    }
+
+    uint32_t next() {
+        const uint32_t r = st[0] + st[3];
+        const uint32_t t = st[1] << 9;
+        st[2] ^= st[0]; st[3] ^= st[1]; st[1] ^= st[2]; st[0] ^= st[3];
+        st[2] ^= t;
+        st[3] = rotl(st[3], 11);
+        return r;
+    }
+
+    //seed for a new sequence: never 0 (0 is "no seed" in .sca files)
+    uint32_t nextSeed() { uint32_t s; while(!(s = next())) ; return s; }
+
+    //[0, 1)
+    float get() { return float(next() >> 8) * (1.f / 16777216.f); }
+    //[min, max)
+    float get(float min, float max) { return min + get() * (max - min); }
+
+    //n values in [min, max): lanes seeded from this generator
+    void fill(float *dst, int n, float min, float max) {
+        uint32_t s0[ATT_RANDOM_LANES], s1[ATT_RANDOM_LANES], s2[ATT_RANDOM_LANES], s3[ATT_RANDOM_LANES];
+        for(int j=0; j<ATT_RANDOM_LANES; j++) {
+            attRandom lane(nextSeed());
+            s0[j] = lane.st[0]; s1[j] = lane.st[1]; s2[j] = lane.st[2]; s3[j] = lane.st[3];
+        }
+
+        const float scale = (max - min) * (1.f / 16777216.f);
+        float r[ATT_RANDOM_LANES];
+        for(int i=0; i<n; i+=ATT_RANDOM_LANES) {
+            for(int j=0; j<ATT_RANDOM_LANES; j++) {
+                r[j] = min + float((s0[j] + s3[j]) >> 8) * scale;
+                const uint32_t t = s1[j] << 9;
+                s2[j] ^= s0[j]; s3[j] ^= s1[j]; s1[j] ^= s2[j]; s0[j] ^= s3[j];
+                s2[j] ^= t;
+                s3[j] = rotl(s3[j], 11);
+            }
+            const int m = n-i < ATT_RANDOM_LANES ? n-i : ATT_RANDOM_LANES;
+            for(int j=0; j<m; j++) dst[i+j] = r[j];
+        }
+    }
+
+private:
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+    static uint64_t splitmix64(uint64_t &z) {
+        uint64_t r = (z += 0x9e3779b97f4a7c15ull);
+        r = (r ^ (r >> 30)) * 0xbf58476d1ce4e5b9ull;
+        r = (r ^ (r >> 27)) * 0x94d049bb133111ebull;
+        return r ^ (r >> 31);
+    }
+
+    uint32_t st[4];
+};
+
+inline attRandom &attRng()
+{
+    static thread_local attRandom rng;
+    return rng;
+}
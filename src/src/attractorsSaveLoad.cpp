@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+////////////////////////////////////////////////////////////////////////////////
+#define CONFIGURU_IMPLEMENTATION 
+#include "libs/configuru/configuru.hpp"
+
+#include "attractorsBase.h"
+
+//  Attractor with scalarK general files
+////////////////////////////////////////////////////////////////////////////
+
+void AttractorBase::saveVals(Config &cfg) 
+{
+    vector<float> v((vVal.size()*3));
+
+    memcpy(v.data(), vVal.data(), vVal.size()*sizeof(glm::vec3));
+
+    cfg["Name"] = getNameID();
+    saveAdditionalData(cfg);
+    if(mathType()) cfg["mathPrecision"] = mathPrecision;
+    if(seed) cfg["seed"] = seed;
+    cfg["kMax" ] = kMax;
+    cfg["kMin" ] = kMin;
+    cfg["vMax" ] = vMax;
+    cfg["vMin" ] = vMin;
+    cfg["vData"] = Config::array(v);
+    saveKVals(cfg);
+}
+
+void AttractorBase::loadVals(Config &cfg) 
+{
+    kMax = cfg.get_or("kMax", kMax);
+    kMin = cfg.get_or("kMin", kMin);
+    vMax = cfg.get_or("vMax", vMax);
+    vMin = cfg.get_or("vMin", vMin);
+    mathPrecision = cfg.get_or("mathPrecision", int(attMathExact));
+    seed = uint32_t(cfg.get_or("seed", int64_t(0)));
+
+    loadAdditionalData(cfg);
+
+    vector<float> v;
+    for (const Config& e : cfg["vData"].as_array()) v.push_back(e.as_float());
+
+    const int vSize = v.size()/3;
+    vVal.resize(vSize);
+
+    memcpy(vVal.data(), v.data(), vSize*sizeof(glm::vec3));
+
+    loadKVals(cfg);
+
+    initStep();
+
+}
+
+//  Attractor with scalarK general files
+////////////////////////////////////////////////////////////////////////////
+void attractorScalarK::loadKVals(Config &cfg) 
+{
+    kVal.clear();
+    for (const Config& e : cfg["kData"].as_array()) kVal.push_back(e.as_float());
+    std::cout << kVal.size() << endl;
+}
+
+void attractorScalarK::saveKVals(Config &cfg) 
+{
+    cfg["kData"] = Config::array(kVal); 
+}
+//  Attractor with vectorK general files
+////////////////////////////////////////////////////////////////////////////
+void attractorVectorK::loadKVals(Config &cfg) 
+{
+    vector<float> k;
+
+    for (const Config& e : cfg["kData"].as_array()) k.push_back(e.as_float());
+
+    const int kSize = k.size()/3;
+
+    kVal.resize(kSize);
+
+    memcpy(kVal.data(), k.data(), kSize*sizeof(glm::vec3));
+
+}
+
+void attractorVectorK::saveKVals(Config &cfg) 
+{
+vector<float>  k((kVal.size()*3));
+
+    memcpy(k.data(), kVal.data(), kVal.size()*sizeof(glm::vec3));
+
+    cfg["kData"] = Config::array(k); 
+}
+
+//  PowerN3D Attractor
+////////////////////////////////////////////////////////////////////////////
+void PowerN3D::saveAdditionalData(Config &cfg) 
+{
+    cfg["Order" ] = order;
+}
+
+void PowerN3D::loadAdditionalData(Config &cfg) 
+{
+    tmpOrder = order= cfg.get_or("Order",order);
+/*
+    nCoeff = getNumCoeff();
+    const int kSize = k.size()/3;
+
+    if(nCoeff!=kSize || v.size()!=3) assert("mismatch loaded size!!");
+
+    resizeBuffers();
+    ResetCurrent();
+
+    memcpy(vVal.data(), v.data(), sizeof(glm::vec3));
+    memcpy(kVal.data(), k.data(), kSize*sizeof(glm::vec3));
+*/
+}
+
+void PowerN3D::saveVals(const char *name) 
+{
+    ofstream ofs(name);
+    ofs.precision(15);
+
+    const int nMagnets = kVal.size();
+
+    ofs << order << endl;
+    ofs << nMagnets << endl;
+
+    ofs <<  vVal[0].x << " " << vVal[0].y << " " << vVal[0].z << endl;
+        
+    for(int i=0; i<nMagnets; i++) {
+        ofs <<  kVal[i].x << " " << kVal[i].y << " " << kVal[i].z << endl;
+    }
+    cout << endl;
+}
+void PowerN3D::loadVals(const char *name) 
+{
+    ifstream ifs(name);
+    ifs.precision(15);
+        
+    ifs >> order;
+    //nCoeff = getNumCoeff();
+    ifs >> nCoeff;
+
+    resetData();
+    resetQueue();
+
+
+    ifs >>  vVal[0].x >> vVal[0].y >> vVal[0].z;
+        
+    for(int i=0; i<nCoeff; i++) {
+        ifs >>  kVal[i].x >> kVal[i].y >> kVal[i].z;
+    }  
+
+    
+}
+
+
+void attractorDtType::saveAdditionalData(Config &cfg)
+{
+        cfg["dtInc"] = dtStepInc;
+        cfg["dtIntegrator"] = integrator;
+        cfg["dtTolerance"] = tolerance;
+        cfg["dtArcLength"] = arcLength;
+}
+void attractorDtType::loadAdditionalData(Config &cfg) 
+{
+    dtStepInc = cfg.get_or("dtInc",dtStepInc);
+    integrator = cfg.get_or("dtIntegrator", int(dtIntEuler));
+    tolerance = cfg.get_or("dtTolerance", 1.e-5f);
+    arcLength = cfg.get_or("dtArcLength", 0.f);
+
+
+}
+
+
+
+
+
+
+//  Magnetic Attractor
+////////////////////////////////////////////////////////////////////////////
+void Magnetic::saveAdditionalData(Config &cfg) 
+{
+        cfg["nMagnets"] = vVal.size();    
+}
+void Magnetic::loadAdditionalData(Config &cfg) 
+{
+        tmpElements = nElements = cfg.get_or("nMagnets",2);
+}
+
+void loadAdditionalData(Config &cfg) {};
+
+void Magnetic::saveVals(const char *name) 
+{
+    ofstream ofs(name);
+    ofs.precision(15);
+
+    const int nMagnets = vVal.size();
+
+    ofs << nMagnets << endl;
+        
+    for(int i=0; i<nMagnets; i++) {
+        ofs <<  kVal[i].x << " " << kVal[i].y << " " << kVal[i].z << endl;
+        ofs <<  vVal[i].x << " " << vVal[i].y << " " << vVal[i].z << endl;
+    }
+    cout << endl;
+}
+
+
+void Magnetic::loadVals(const char *name) 
+{  
+    //string line;         
+
+    ifstream ifs(name);
+    ifs.precision(15);
+        
+    int nMagnets;;
+    ifs >> nMagnets;
+
+    resetQueue();
+    //ResizeVectors();        
+    kVal.resize(nMagnets);
+    vVal.resize(nMagnets);       
+
+        
+    for(int i=0; i<nMagnets; i++) {
+        ifs >>  kVal[i].x >> kVal[i].y >> kVal[i].z;
+        ifs >>  vVal[i].x >> vVal[i].y >> vVal[i].z;
+    }  
+    valuesChanged();
+
+    
+}
+
+//  Attractor Continer Class
+////////////////////////////////////////////////////////////////////////////
+bool AttractorsClass::loadSelected(Config &c)
+{
+    int i = getSelectionByName((std::string)c.get_or("Name",""));
+    if(i<0) return false;
+
+    selected = i;
+    get()->loadVals(c);
+    return true;
+}
+
+void AttractorsClass::saveFile(const char *name) 
+{
+    Config cfg = Config::object();
+
+    saveVals(cfg);
+
+    configuru::dump_file(name, cfg, configuru::JSON);
+}
+
+void AttractorsClass::saveVals(Config &cfg)
+{
+    auto &a = cfg["Attractor"] = Config::object();
+    get()->saveVals(a);
+
+}
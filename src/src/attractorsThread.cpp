@@ -0,0 +1,384 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <iostream>
+
+#include "glWindow.h"
+
+#include "attractorsBase.h"
+
+AttractorsClass attractorsList; // need to resolve inlines
+
+//  Thread endless loop
+///////////////////////////////////////
+void AttractorsClass::endlessStep(emitterBaseClass *emitter)
+{
+    //typedef void (AttractorBase::*threadStepPtrFn)(float *&ptr,vec3 &v, vec3 &vp);
+    typedef void (AttractorBase::*threadStepPtrFn)(float *&ptr,vec3 &v, vec3 &vp);
+
+    auto singleStep = [&] (float *ptr) -> void
+    {
+        //mtxStep.lock();
+
+        if(!emitter->isEmitterOn() || getSelection() < 0) return;
+
+#ifdef USE_MAPPED_BUFFER
+        std::atomic<GLuint64> &inc = *emitter->getVBO()->getPtrVertexUploaded();
+        const uint szBuffer = emitter->getSizeCircularBuffer(); 
+        const GLuint64 start = inc;
+        // from current position to the end of circular buffer, or of segments granted
+        const GLuint64 end = std::min(start + (szBuffer - start%szBuffer), emitter->getVBO()->getWriteLimit());
+        getThreadStep()->fillBuffer(ptr, szBuffer, start, end, inc);
+#else
+        // whole staging block, or partial if emitter is stopped
+        std::atomic<uint64_t> countVtx { 0 };
+        getThreadStep()->fillBuffer(ptr, emitter->getSizeStepBuffer(), 0, emitter->getSizeStepBuffer(), countVtx);
+        if(countVtx) emitter->getVBO()->publishStaging(GLuint(countVtx.load()));
+#endif
+        //mtxStep.unlock();
+    };       
+
+    // running flag is raised under stepMutex: stopThread, after emitter off,
+    // waits (idleCondVar) only for the step in progress
+    auto setRunning = [&] (bool b) {
+        { std::lock_guard<std::mutex> lock(stepMutex); emitter->setThreadRunning(b); }
+        if(!b) idleCondVar.notify_all();
+    };
+
+    while(endlessLoop) {
+        {
+            std::unique_lock<std::mutex> mlock(stepMutex);
+            stepCondVar.wait(mlock, std::bind(&emitterBaseClass::loopCanStart, emitter));
+            if(!endlessLoop) break;
+            emitter->setThreadRunning(true);
+        }
+
+#ifdef USE_MAPPED_BUFFER
+        const GLuint64 start = emitter->getVBO()->getVertexUploaded();
+        singleStep(emitter->getVBO()->getBuffer()); 
+        const GLuint64 uploaded = emitter->getVBO()->getVertexUploaded();
+
+        // end of circular buffer: VBO indexes are reset by render loop
+        if(emitter->isEmitterOn() && uploaded != start && !(uploaded % emitter->getSizeCircularBuffer())) {
+            if(emitter->stopFull()) emitter->setEmitterOff();
+            if(emitter->restartCircBuff()) {
+                get()->initStep();
+                emitter->needRestartCircBuffer(true);
+            }
+        }
+#else
+        // VBO indexes already reset by render loop
+        if(emitter->needRestartCircBuffer()) {
+            get()->initStep();
+            emitter->needRestartCircBuffer(false);
+        }
+
+        singleStep(emitter->getVBO()->getStagingBlock()); 
+#endif
+        setRunning(false);
+    };
+    
+}
+
+//  Attractors Thread helper class
+////////////////////////////////////////////////////////////////////////////
+void threadStepClass::newThread()
+{
+#ifdef USE_THREAD_TO_FILL
+    attractorsList.queryStartThread();  //endlessLoop = true
+    if(attractorLoop == nullptr) {
+        attractorLoop = new thread(&AttractorsClass::endlessStep, &attractorsList, emitter);
+        //attractorLoop->detach();
+
+        const int nWorkers = theApp->getEmitThreads();
+        workersOrbits.resize(nWorkers);
+        poolExit = false;
+        for(int i=1; i<nWorkers; i++) 
+            workers.push_back(new thread(&threadStepClass::workerLoop, this, i));
+    }
+#endif
+}
+void threadStepClass::startThread(bool stratOn)
+{
+    emitter->setEmitter(stratOn);
+}
+
+void threadStepClass::deleteThread()
+{
+#ifdef USE_THREAD_TO_FILL
+    if(getThread() && (getThread()->get_id() != std::thread::id())) {
+        attractorsList.queryStopThread();
+        stopThread();
+        getThread()->join();
+        delete getThread();
+        //attractorLoop = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            poolExit = true;
+        }
+        poolCondVar.notify_all();
+        for(auto &w : workers) {
+            w->join();
+            delete w;
+        }
+        workers.clear();
+    }
+#endif
+}
+
+void threadStepClass::stopThread() {
+#ifdef USE_THREAD_TO_FILL
+    emitter->setEmitterOff();
+    // emitter off: fill loop exits at next STEP_BATCH_SIZE
+    std::unique_lock<std::mutex> lock(attractorsList.getStepMutex());
+    attractorsList.idleCondVar.wait(lock, [&] { return emitter->isLoopStopped(); });
+#endif
+}
+
+void threadStepClass::notify() {
+#ifdef USE_THREAD_TO_FILL
+    // empty lock: no lost wakeup between loopCanStart test and wait
+    { std::lock_guard<std::mutex> lock(attractorsList.getStepMutex()); }
+    attractorsList.stepCondVar.notify_one();
+#endif
+}
+
+void threadStepClass::restartEmitter() { 
+    emitter->resetVBOindexes(); 
+    emitter->setColorData(false);
+    emitter->requestFit();
+#if defined(USE_THREAD_TO_FILL) && !defined(USE_MAPPED_BUFFER)
+    emitter->getVBO()->flushStaging();
+#endif
+    attractorsList.get()->resetStats();
+    attractorsList.resetHealth();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    pendingStats.reset();
+}
+
+void threadStepClass::collectStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if(pendingStats.isEmpty()) return;
+    attractorsList.get()->getStats().merge(pendingStats);
+    pendingStats.reset();
+}
+
+//  fit pending: points out of box, all points are restarted w/ new box
+bool threadStepClass::canStep()
+{
+    return emitter->isEmitterOn() && !emitter->isFitPending();
+}
+
+void threadStepClass::fillBuffer(float *buffer, uint64_t wrap, uint64_t start, uint64_t end, std::atomic<uint64_t> &emitted)
+{
+    AttractorBase *att = attractorsList.get();
+
+    job.buffer = buffer; job.wrap = wrap; job.end = end;
+    job.packing = &emitter->getPacking();
+    job.target = &emitted;
+    job.claimed = start; job.published = start;
+    job.att = att;
+    job.startPoint = att->getCurrent();
+    job.nOrbits = attractorsList.getOrbits().getOrbits();
+
+    if(workers.size()) {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            workersBusy = workers.size();
+            jobID++;
+        }
+        poolCondVar.notify_all();
+    }
+
+    stepChunks(0);
+
+    while(workersBusy.load()) std::this_thread::yield();
+}
+
+void threadStepClass::workerLoop(int idx)
+{
+    uint lastJob = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            poolCondVar.wait(lock, [&] { return poolExit || jobID!=lastJob; });
+            if(poolExit) return;
+            lastJob = jobID;
+        }
+        stepChunks(idx);
+        workersBusy--;
+    }
+}
+
+//  worker 0 continues main orbit, others have own orbits seeded near it
+void threadStepClass::stepChunks(int idx)
+{
+    AttractorBase *att = job.att;
+    multiOrbitClass &orbits = idx ? workersOrbits[idx] : attractorsList.getOrbits();
+    const bool multiOrbit = job.nOrbits>1;
+
+    if(idx || multiOrbit) {
+        if(orbits.getOrbits()!=job.nOrbits) orbits.setOrbits(job.nOrbits);
+        orbits.checkSeeds(att, job.startPoint, idx>0);
+    }
+
+    vec3 v = idx ? orbits.getAt(0) : job.startPoint;
+    vec3 vp = v;
+
+    const vertexPacking &packing = *job.packing;
+    const uint bytesPerVertex = packing.getBytesPerVertex();
+    thread_local vector<float> scratch(STEP_BATCH_SIZE*4);
+    emissionStats partial;
+
+    while(canStep()) {
+        const uint64_t first = job.claimed.fetch_add(STEP_BATCH_SIZE);
+        if(first >= job.end) break;
+        const uint nPoints = uint(std::min(uint64_t(STEP_BATCH_SIZE), job.end - first));
+        uint8_t *dst = (uint8_t *) job.buffer + (first % job.wrap) * bytesPerVertex;
+        // packed: steps in scratch, then to buffer
+        float *batch = packing.isPacked() ? scratch.data() : (float *) dst;
+
+        // dead orbit: batch again from a point near last good state (batch start),
+        // emission paused when reseeds are exhausted
+        const vec3 vGood = multiOrbit ? orbits.getAt(0) : v;
+        int health;
+        while(true) {
+            float *ptr = batch;
+            if(multiOrbit) att->Step(ptr, orbits, nPoints);
+            else           att->Step(ptr, v, vp, nPoints);
+
+            health = checkEmissionHealth(batch, nPoints);
+            if(health == emitHealthy || !attractorsList.reportDeadOrbit(health)) break;
+            if(multiOrbit) orbits.seed(att, vGood, true);
+            else           vp = v = AttractorsClass::reseedNear(vGood);
+        }
+        if(health != emitHealthy) {
+            // still published (points are contiguous): as still points on last good state
+            for(uint i=0; i<nPoints; i++) { batch[i*4] = vGood.x; batch[i*4+1] = vGood.y; batch[i*4+2] = vGood.z; batch[i*4+3] = 0.f; }
+            if(multiOrbit) orbits.seed(att, vGood, true);
+            else           vp = v = vGood;
+            emitter->setEmitterOff();
+        }
+
+        else partial.accumulate(batch, nPoints);
+        vec4 bMin, bMax;
+        if(packing.isPacked() && !packing.pack(scratch.data(), dst, nPoints, &bMin, &bMax)) 
+            emitter->requestRefit(bMin, bMax);
+
+        // publish in order: emitted points are always contiguous
+        while(job.published.load(std::memory_order_acquire) != first) std::this_thread::yield();
+        job.target->store(first + nPoints, std::memory_order_release);
+        job.published.store(first + nPoints, std::memory_order_release);
+    }
+
+    if(!idx) att->Insert(multiOrbit ? orbits.getAt(0) : vp);
+    else if(!multiOrbit) orbits.setAt(0, vp);
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    pendingStats.merge(partial);
+}
+   
+//  Attractor Class container
+////////////////////////////////////////////////////////////////////////////
+void AttractorsClass::newSelection(int i) {
+    if(i==getSelection()) return;
+    cancelNewRandom();
+    getThreadStep()->stopThread();
+    selection(i);
+    theApp->getMainDlg().getParticlesDlgClass().resetTreeParticlesFlags();
+    theApp->loadAttractor(getFileName().c_str());
+    getThreadStep()->restartEmitter();
+    get()->initStep();
+    getThreadStep()->startThread();
+
+}
+void AttractorsClass::selection(int i) {
+    selected = i; 
+    theWnd->getParticlesSystem()->getTMat()->setView(get()->getPOV(),get()->getTGT());
+    //restart();    
+}
+
+
+void AttractorsClass::newStepThread(emitterBaseClass *e) 
+{
+    threadStep = new threadStepClass(e);
+}
+
+void AttractorsClass::deleteStepThread() 
+{
+    delete threadStep;
+    threadStep = nullptr;
+}
+
+void AttractorsClass::generateNewRandom() {
+    // candidates already found are valid only w/ same settings
+    if(!search.isSameSearch(get())) search.start(get());
+
+    searchPending = true;
+    checkNewRandom();
+}
+
+//  called each frame: applies first result of search, if pending
+void AttractorsClass::checkNewRandom() {
+    if(!searchPending) return;
+
+    Config c;
+    if(!search.popResult(c)) return;
+    searchPending = false;
+
+    getThreadStep()->stopThread();
+
+    get()->loadVals(c);
+
+    getThreadStep()->restartEmitter();
+    get()->initStep();
+
+    getThreadStep()->startThread();
+}
+
+
+void AttractorsClass::restart()
+{
+    getThreadStep()->stopThread();
+    getThreadStep()->restartEmitter();
+    get()->initStep();
+    getThreadStep()->startThread();
+
+//    if(!theWnd->getParticlesSystem()->getEmitter()->isEmitterOn())
+        //theWnd->getParticlesSystem()->getEmitter()->setEmitterOn();
+
+}
@@ -0,0 +1,479 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include <cmath>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "chaosCore.h"
+
+//  max points for each Step call
+#define FILL_CHUNK (1<<24)
+
+chaosAttractorClass *chaosAttractorClass::newAttractor(const string &nameID)
+{
+    AttractorBase *a = AttractorsClass::newAttractor(nameID);
+    return a ? new chaosAttractorClass(a) : nullptr;
+}
+
+chaosAttractorClass *chaosAttractorClass::newAttractorFromFile(const char *name)
+{
+    try {
+        Config cfg = configuru::parse_file(name, JSON);
+        if(!cfg.has_key("Attractor")) return nullptr;
+
+        chaosAttractorClass *att = newAttractor((std::string)cfg["Attractor"].get_or("Name",""));
+        if(att) att->loadVals(cfg);
+        return att;
+    }
+    catch (const std::exception &e) {
+        cerr << e.what() << endl;
+        return nullptr;
+    }
+}
+
+const vector<string> &chaosAttractorClass::getNameIDs()
+{
+#define NAME_ID(ATT,DISPLAY_NAME) #ATT,
+    static const vector<string> nameIDs = { ATTRACTORS_LIST(NAME_ID) };
+#undef NAME_ID
+    return nameIDs;
+}
+
+bool chaosAttractorClass::loadVals(Config &cfg)
+{
+    if(!cfg.has_key("Attractor")) return false;
+    auto& c = cfg["Attractor"];
+    if((std::string)c.get_or("Name","") != att->getNameID()) return false;
+
+    att->loadVals(c);
+    return true;
+}
+
+void chaosAttractorClass::saveVals(Config &cfg)
+{
+    auto &a = cfg["Attractor"] = Config::object();
+    att->saveVals(a);
+}
+
+bool chaosAttractorClass::loadFile(const char *name)
+{
+    try {
+        Config cfg = configuru::parse_file(name, JSON);
+        return loadVals(cfg);
+    }
+    catch (const std::exception &e) {
+        cerr << e.what() << endl;
+        return false;
+    }
+}
+
+void chaosAttractorClass::saveFile(const char *name)
+{
+    Config cfg = Config::object();
+    saveVals(cfg);
+    configuru::dump_file(name, cfg, configuru::JSON);
+}
+
+void chaosAttractorClass::fill(float *buffer, uint64_t numPoints)
+{
+    while(numPoints) {
+        const uint n = uint(std::min(numPoints, uint64_t(FILL_CHUNK)));
+        if(orbits.isMultiOrbit()) {
+            orbits.checkSeeds(att);
+            att->Step(buffer, orbits, n);       // buffer is advanced
+            att->Insert(orbits.getAt(0));
+        } else {
+            att->Step(buffer, n);
+            buffer += n*4;
+        }
+        numPoints -= n;
+    }
+}
+
+//  Lyapunov map
+////////////////////////////////////////////////////////////////////////////
+static float axisValue(const lyapunovMapAxis &a, int i)
+{
+    return a.size>1 ? a.min + (a.max - a.min) * float(i) / float(a.size-1) : a.min;
+}
+
+void lyapunovMapClass::compute(int nSteps, int nThreads)
+{
+    if(nThreads<=0) nThreads = std::max(int(std::thread::hardware_concurrency()), 1);
+
+    map.assign(size_t(axisX.size) * axisY.size, NAN);
+    nextTile = 0;
+
+    Config values = Config::object();
+    source->get()->saveVals(values);
+
+    // values copied for each worker: configuru marks accessed keys also on read
+    vector<thread> workers;
+    for(int i=1; i<nThreads; i++) workers.emplace_back(&lyapunovMapClass::computeTiles, this, nSteps, values);
+    computeTiles(nSteps, values);
+    for(auto &w : workers) w.join();
+}
+
+void lyapunovMapClass::computeTiles(int nSteps, Config values)
+{
+    AttractorBase *att = AttractorsClass::newAttractor(source->getNameID());
+    if(!att) return;
+    att->loadVals(values);
+
+    const int tilesX = (axisX.size + LYAPUNOV_MAP_TILE-1) / LYAPUNOV_MAP_TILE;
+    const int tilesY = (axisY.size + LYAPUNOV_MAP_TILE-1) / LYAPUNOV_MAP_TILE;
+
+    for(int tile; (tile = nextTile++) < tilesX*tilesY; ) {
+        const int x0 = (tile % tilesX) * LYAPUNOV_MAP_TILE, x1 = std::min(x0 + LYAPUNOV_MAP_TILE, axisX.size);
+        const int y0 = (tile / tilesX) * LYAPUNOV_MAP_TILE, y1 = std::min(y0 + LYAPUNOV_MAP_TILE, axisY.size);
+
+        for(int y=y0; y<y1; y++)
+            for(int x=x0; x<x1; x++) {
+                att->setValue(axisX.row, axisX.col, AttractorBase::attLoadKtVal, axisValue(axisX, x));
+                att->setValue(axisY.row, axisY.col, AttractorBase::attLoadKtVal, axisValue(axisY, y));
+                att->initStep();
+
+                // same perturbation for all cells: map w/o random noise
+                const vec3 v0(att->getCurrent());
+                const vec3 ve(v0 + vec3(1.e-3f));
+
+                map[size_t(y)*axisX.size + x] = att->lyapunovDivergent(LYAPUNOV_MAP_SKIP) ? NAN : 
+                                                att->lyapunovExponent(ve, distance(v0, ve), nSteps);
+            }
+    }
+
+    delete att;
+}
+
+bool lyapunovMapClass::saveCSV(const char *name)
+{
+    FILE *f = fopen(name, "w");
+    if(!f) return false;
+
+    for(int y=0; y<axisY.size; y++)
+        for(int x=0; x<axisX.size; x++)
+            fprintf(f, x<axisX.size-1 ? "%g," : "%g\n", map[size_t(y)*axisX.size + x]);
+
+    return !fclose(f);
+}
+
+bool lyapunovMapClass::savePFM(const char *name)
+{
+    FILE *f = fopen(name, "wb");
+    if(!f) return false;
+
+    // negative scale: little endian
+    const uint16_t endian = 1;
+    fprintf(f, "Pf\n%d %d\n%s\n", axisX.size, axisY.size, *(const uint8_t *)&endian ? "-1.0" : "1.0");
+    const bool ok = fwrite(map.data(), sizeof(float), map.size(), f) == map.size();
+
+    return !fclose(f) && ok;
+}
+
+
+//  Points archive
+////////////////////////////////////////////////////////////////////////////
+#define ARCHIVE_MAX_K 24                // Rice parameter: code <= 32+24 bits
+#define ARCHIVE_ESCAPE 32               // unary ones before a raw 32 bit value
+#define ARCHIVE_MAX_Q (1<<28)           // quantized range: residuals in int32
+#define ARCHIVE_PADDING 40              // zeros after bitstream: reads w/o checks
+#define ARCHIVE_BLOCK_HEADER 12         // points (uint32), predictor[4], k[4]
+
+static inline int countTrailingZeros(uint64_t v)
+{
+#ifdef _MSC_VER
+    unsigned long i;
+    if(_BitScanForward(&i, uint32_t(v))) return int(i);
+    _BitScanForward(&i, uint32_t(v >> 32));
+    return int(i) + 32;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+//  predictors: delta (previous point), linear extrapolation of last two or,
+//  for w only, distance of current point from previous one (w of emitter)
+enum { archivePredDelta, archivePredLinear, archivePredDistance };
+
+class archivePredictor {
+public:
+    archivePredictor(const vec4 &origin, const vec4 &step) : step(step), originW(origin.w), invStepW(1.f / step.w) {}
+    //q: current point, x, y, z already known for w
+    int32_t operator()(int pred, int c, const int32_t *q) const {
+        if(pred == archivePredDelta) return q1[c];
+        if(pred == archivePredLinear) return int32_t(2u*uint32_t(q1[c]) - uint32_t(q2[c]));    // wraps on corrupted data
+        const vec3 d = vec3(float(int64_t(q[0])-q1[0]), float(int64_t(q[1])-q1[1]), float(int64_t(q[2])-q1[2])) * step;
+        return int32_t(glm::clamp(std::round((length(d) - originW) * invStepW), -float(ARCHIVE_MAX_Q), float(ARCHIVE_MAX_Q)));
+    }
+    void push(const int32_t *q, bool first) {
+        for(int c=0; c<4; c++) { q2[c] = first ? q[c] : q1[c]; q1[c] = q[c]; }
+    }
+    int32_t q1[4] = {}, q2[4] = {};
+private:
+    vec3 step;
+    float originW, invStepW;
+};
+static inline uint32_t zigZag(int32_t r) { return (uint32_t(r) << 1) ^ uint32_t(r >> 31); }
+static inline int32_t unZigZag(uint32_t u) { return int32_t(u >> 1) ^ -int32_t(u & 1); }
+
+class bitWriter {
+public:
+    bitWriter(vector<uint8_t> &out) : out(out) {}
+    void put(uint32_t bits, int n) {
+        acc |= uint64_t(bits) << nBits;
+        for(nBits += n; nBits >= 8; nBits -= 8, acc >>= 8) out.push_back(uint8_t(acc));
+    }
+    void putRice(uint32_t u, int k) {
+        const uint32_t q = u >> k;
+        if(q < ARCHIVE_ESCAPE) { 
+            put((1u << q) - 1, q + 1);              // q ones and a zero
+            if(k) put(u & ((1u << k) - 1), k);
+        } else {
+            put(~0u, ARCHIVE_ESCAPE);
+            put(u, 32);
+        }
+    }
+    void flush() { if(nBits) out.push_back(uint8_t(acc)); acc = 0; nBits = 0; }
+private:
+    vector<uint8_t> &out;
+    uint64_t acc = 0;
+    int nBits = 0;
+};
+
+static inline uint64_t peekBits(const uint8_t *p, uint64_t pos)
+{
+    uint64_t v;
+    memcpy(&v, p + (pos >> 3), sizeof(v));
+    return v >> (pos & 7);
+}
+
+static inline uint32_t getRice(const uint8_t *p, uint64_t &pos, int k)
+{
+    const uint64_t v = peekBits(p, pos);
+    const int q = ~v ? countTrailingZeros(~v) : 64;
+    if(q < ARCHIVE_ESCAPE) {
+        pos += q + 1 + k;
+        return (uint32_t(q) << k) | (uint32_t(v >> (q + 1)) & ((1u << k) - 1));
+    }
+    const uint32_t u = uint32_t(peekBits(p, pos + ARCHIVE_ESCAPE));
+    pos += ARCHIVE_ESCAPE + 32;
+    return u;
+}
+
+bool pointsArchiveWriter::open(FILE *f, float relErr)
+{
+    file = f;
+    relError = relErr;
+    hasBox = false;
+    count = offset = 0;
+    vMin = vec4(FLT_MAX); vMax = vec4(-FLT_MAX);
+    index.clear();
+    pending.clear();
+    return file != nullptr && relError > 0.f;
+}
+
+bool pointsArchiveWriter::write(const float *pts, uint n)
+{
+    while(n) {
+        // full blocks w/o copy
+        if(pending.empty() && n >= ARCHIVE_BLOCK) {
+            if(!writeBlock(pts, ARCHIVE_BLOCK)) return false;
+            pts += ARCHIVE_BLOCK*4; n -= ARCHIVE_BLOCK;
+            continue;
+        }
+        const uint nCopy = std::min(n, uint(ARCHIVE_BLOCK - pending.size()/4));
+        pending.insert(pending.end(), pts, pts + nCopy*4);
+        pts += nCopy*4; n -= nCopy;
+        if(pending.size() == ARCHIVE_BLOCK*4) {
+            if(!writeBlock(pending.data(), ARCHIVE_BLOCK)) return false;
+            pending.clear();
+        }
+    }
+    return true;
+}
+
+//  quantization grid: from box of first block if not set
+bool pointsArchiveWriter::writeHeader(const float *pts, uint n)
+{
+    if(!hasBox) {
+        boxMin = vec4(FLT_MAX); boxMax = vec4(-FLT_MAX);
+        for(uint i=0; i<n; i++) {
+            const vec4 v = glm::make_vec4(pts + i*4);
+            if(any(isnan(v)) || any(isinf(v))) continue;
+            boxMin = min(boxMin, v); boxMax = max(boxMax, v);
+        }
+        if(boxMin.x > boxMax.x) boxMin = boxMax = vec4(0.f);
+    }
+    step = max(2.f * relError * (boxMax - boxMin), vec4(FLT_MIN));
+    origin = boxMin;
+    invStep = 1.f / step;
+
+    archiveHeader header;
+    memcpy(header.magic, ARCHIVE_MAGIC, 4);
+    header.version = ARCHIVE_VERSION;
+    memcpy(header.origin, glm::value_ptr(origin), sizeof(header.origin));
+    memcpy(header.step, glm::value_ptr(step), sizeof(header.step));
+    offset = sizeof(header);
+    return fwrite(&header, sizeof(header), 1, file) == 1;
+}
+
+bool pointsArchiveWriter::writeBlock(const float *pts, uint n)
+{
+    if(!offset && !writeHeader(pts, n)) return false;
+
+    // quantize: non-finite values as previous one
+    quantized.resize(size_t(n)*4);
+    archivePredictor predictor(origin, step);
+    uint64_t cost[4][3] = {};
+    for(uint i=0; i<n; i++) {
+        const vec4 pt = glm::make_vec4(pts + i*4);
+        if(!any(isnan(pt)) && !any(isinf(pt))) { vMin = min(vMin, pt); vMax = max(vMax, pt); }
+
+        int32_t *q = quantized.data() + size_t(i)*4;
+        for(int c=0; c<4; c++) {
+            const float v = (pts[i*4+c] - origin[c]) * invStep[c];
+            q[c] = std::isfinite(v) ? int32_t(glm::clamp(std::round(v), -float(ARCHIVE_MAX_Q), float(ARCHIVE_MAX_Q))) : predictor.q1[c];
+            for(int pr=0; pr<(c==3 ? 3 : 2); pr++) cost[c][pr] += zigZag(q[c] - predictor(pr, c, q));
+        }
+        predictor.push(q, !i);
+    }
+
+    // for each component: best predictor, Rice parameter ~ log2(mean residual)
+    uint8_t pred[4], k[4];
+    for(int c=0; c<4; c++) {
+        pred[c] = cost[c][archivePredLinear] < cost[c][archivePredDelta] ? archivePredLinear : archivePredDelta;
+        if(c==3 && cost[c][archivePredDistance] < cost[c][pred[c]]) pred[c] = archivePredDistance;
+        const uint64_t mean = cost[c][pred[c]] / n;
+        for(k[c] = 0; k[c] < ARCHIVE_MAX_K && (uint64_t(2) << k[c]) <= mean; k[c]++);
+    }
+
+    encoded.resize(ARCHIVE_BLOCK_HEADER);
+    memcpy(encoded.data(), &n, sizeof(uint32_t));
+    memcpy(encoded.data()+4, pred, 4);
+    memcpy(encoded.data()+8, k, 4);
+
+    bitWriter bits(encoded);
+    predictor = archivePredictor(origin, step);
+    for(uint i=0; i<n; i++) {
+        const int32_t *q = quantized.data() + size_t(i)*4;
+        for(int c=0; c<4; c++) bits.putRice(zigZag(q[c] - predictor(pred[c], c, q)), k[c]);
+        predictor.push(q, !i);
+    }
+    bits.flush();
+    encoded.resize(encoded.size() + ARCHIVE_PADDING, 0);
+
+    index.push_back(offset);
+    if(fwrite(encoded.data(), 1, encoded.size(), file) != encoded.size()) return false;
+    offset += encoded.size();
+    count += n;
+    return true;
+}
+
+bool pointsArchiveWriter::close()
+{
+    if(!pending.empty() && !writeBlock(pending.data(), uint(pending.size()/4))) return false;
+    pending.clear();
+    if(!offset && !writeHeader(nullptr, 0)) return false;     // empty archive
+
+    archiveFooter footer = {};
+    footer.count = count;
+    footer.indexOffset = offset;
+    footer.nBlocks = uint32_t(index.size());
+    footer.blockSize = ARCHIVE_BLOCK;
+    if(vMin.x > vMax.x) vMin = vMax = vec4(0.f);
+    memcpy(footer.bMin, glm::value_ptr(vMin), sizeof(footer.bMin));
+    memcpy(footer.bMax, glm::value_ptr(vMax), sizeof(footer.bMax));
+    memcpy(footer.magic, ARCHIVE_MAGIC, 4);
+
+    const bool ok = fwrite(index.data(), sizeof(uint64_t), index.size(), file) == index.size() &&
+                    fwrite(&footer, sizeof(footer), 1, file) == 1;
+    offset += index.size()*sizeof(uint64_t) + sizeof(footer);
+    return ok;
+}
+
+bool pointsArchiveReader::open(const uint8_t *d, uint64_t size)
+{
+    data = d;
+    if(size < sizeof(archiveHeader) + sizeof(archiveFooter)) return false;
+    memcpy(&header, data, sizeof(header));
+    memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+    if(memcmp(header.magic, ARCHIVE_MAGIC, 4) || memcmp(footer.magic, ARCHIVE_MAGIC, 4) || header.version != ARCHIVE_VERSION ||
+       !footer.blockSize || footer.indexOffset + uint64_t(footer.nBlocks)*sizeof(uint64_t) + sizeof(footer) != size ||
+       (footer.count + footer.blockSize-1) / footer.blockSize != footer.nBlocks) return false;
+
+    // blocks in order, each w/ its header and padding
+    uint64_t next = sizeof(header);
+    for(int b=0; b<getNumBlocks(); b++) {
+        const uint64_t o = blockOffset(b);
+        if(o < next) return false;
+        next = o + ARCHIVE_BLOCK_HEADER + ARCHIVE_PADDING;
+    }
+    return next <= footer.indexOffset;
+}
+
+bool pointsArchiveReader::decodeBlock(int b, float *dst, uint n) const
+{
+    const uint64_t o = blockOffset(b);
+    const uint64_t end = b+1 < int(footer.nBlocks) ? blockOffset(b+1) : footer.indexOffset;
+    const uint8_t *p = data + o;
+
+    uint32_t nBlock;
+    uint8_t pred[4], k[4];
+    memcpy(&nBlock, p, sizeof(nBlock));
+    memcpy(pred, p+4, 4);
+    memcpy(k, p+8, 4);
+    if(n > nBlock) return false;
+    for(int c=0; c<4; c++) if(pred[c] > (c==3 ? archivePredDistance : archivePredLinear) || k[c] > ARCHIVE_MAX_K) return false;
+
+    // each point reads <= 4*64 bits: inside padding while start is in bitstream
+    p += ARCHIVE_BLOCK_HEADER;
+    const uint64_t maxPos = (end - o - ARCHIVE_BLOCK_HEADER - ARCHIVE_PADDING) * 8;
+    const vec4 origin = glm::make_vec4(header.origin), step = glm::make_vec4(header.step);
+
+    archivePredictor predictor(origin, step);
+    uint64_t pos = 0;
+    for(uint i=0; i<n; i++) {
+        if(pos > maxPos) return false;
+        int32_t q[4];
+        for(int c=0; c<4; c++) {
+            q[c] = int32_t(uint32_t(predictor(pred[c], c, q)) + uint32_t(unZigZag(getRice(p, pos, k[c]))));
+            *dst++ = origin[c] + float(q[c]) * step[c];
+        }
+        predictor.push(q, !i);
+    }
+    return pos <= maxPos;
+}
@@ -0,0 +1,240 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "attractorsBase.h"
+
+//  chaosCore: attractors engine, w/o rendering
+//
+//  Each chaosAttractorClass owns its attractor and orbits: different
+//  objects can be used at same time from different threads
+////////////////////////////////////////////////////////////////////////////
+class chaosAttractorClass
+{
+public:
+    //new attractor w/ start data: nullptr if nameID is unknown
+    static chaosAttractorClass *newAttractor(const string &nameID);
+    //new attractor from .sca/.chatt file: nullptr if not valid
+    static chaosAttractorClass *newAttractorFromFile(const char *name);
+    //nameID of all registered attractors
+    static const vector<string> &getNameIDs();
+
+    ~chaosAttractorClass() { delete att; }
+
+    //  Load/Save: "Attractor" node of .sca/.chatt files
+    ///////////////////////////////////////
+    bool loadVals(Config &cfg);
+    void saveVals(Config &cfg);
+    bool loadFile(const char *name);
+    void saveFile(const char *name);
+
+    //  Parameters: type is AttractorBase::attLoadPtVal (start values)
+    //  or AttractorBase::attLoadKtVal (coefficients)
+    ///////////////////////////////////////
+    int getNumElements(int type) { return att->getNumElements(type); }
+    float getValue(int row, int col, int type) { return att->getValue(row, col, type); }
+    void setValue(int row, int col, int type, float val) { att->setValue(row, col, type, val); }
+
+    //sin/cos/... in Step: attMathExact, attMathFast, attMathFastest
+    //(only for mathType() attractors, others are always exact)
+    bool mathType() { return att->mathType(); }
+    void setMathPrecision(int p) { att->setMathPrecision(p); }
+    int getMathPrecision() { return att->getMathPrecision(); }
+
+    //d(x,y,z)/dt attractors only: time step and integration method (dtIntegrators)
+    bool dtType() { return att->dtType(); }
+    void setDtStepInc(float dt) { dtAtt()->setDtStepInc(dt); }
+    float getDtStepInc() { return dtAtt()->getDtStepInc(); }
+    void setIntegrator(int i) { dtAtt()->setIntegrator(i); }
+    int getIntegrator() { return dtAtt()->getIntegrator(); }
+    //emits a point for each arc length advanced by trajectory: 0 for each step
+    void setArcLength(float f) { dtAtt()->setArcLength(f); }
+    float getArcLength() { return dtAtt()->getArcLength(); }
+
+    void newRandomValues() { att->randomValues(attRng().nextSeed()); att->initStep(); att->searchAttractor(); }
+    //values regenerated from seed of a found attractor (getSeed), w/ same limits
+    void newRandomValues(uint32_t seed) { att->randomValues(seed); att->initStep(); }
+    uint32_t getSeed() { return att->getSeed(); }
+    //restart from start values: needed after parameters changes
+    void restart() { att->initStep(); }
+
+    //  Points generation
+    ///////////////////////////////////////
+    //multi-orbit emission: 1..MULTI_ORBIT_MAX orbits interleaved in buffer
+    void setOrbits(int n) { orbits.setOrbits(n); }
+    int getOrbits() { return orbits.getOrbits(); }
+
+    //fill buffer w/ numPoints * 4 floats: x, y, z, distance from previous point
+    void fill(float *buffer, uint64_t numPoints);
+
+    vec3 &getCurrent() { return att->getCurrent(); }
+    const string &getNameID() { return att->getNameID(); }
+    AttractorBase *get() { return att; }
+
+private:
+    chaosAttractorClass(AttractorBase *a) : att(a) {}
+    attractorDtType *dtAtt() { return static_cast<attractorDtType *>(att); }
+
+    AttractorBase *att;
+    multiOrbitClass orbits;
+};
+
+//  Lyapunov map: largest Lyapunov exponent over a grid of values of two
+//  coefficients, kVal[row][col] (col ignored for scalar coefficients)
+//
+//  Cells are computed by tiles on worker threads, each w/ its own copy of
+//  the attractor; cells w/ escaping orbit (or converging to a point) in
+//  first LYAPUNOV_MAP_SKIP steps are NaN, w/o computing the exponent
+////////////////////////////////////////////////////////////////////////////
+#define LYAPUNOV_MAP_TILE 16
+#define LYAPUNOV_MAP_SKIP 300
+
+struct lyapunovMapAxis {
+    int row = 0, col = 0;
+    float min = 0.f, max = 1.f;
+    int size = 256;
+};
+
+class lyapunovMapClass
+{
+public:
+    //x: columns of map, y: rows
+    lyapunovMapClass(chaosAttractorClass *att, const lyapunovMapAxis &x, const lyapunovMapAxis &y) 
+        : source(att), axisX(x), axisY(y) {}
+
+    //nSteps: exponent iterations for each cell, nThreads = 0: all cores
+    void compute(int nSteps = 2000, int nThreads = 0);
+
+    //row-major, axisY.size rows of axisX.size values
+    const vector<float> &getMap() { return map; }
+
+    //CSV: a line for each row; PFM: float image (bottom row is axisY.min)
+    bool saveCSV(const char *name);
+    bool savePFM(const char *name);
+
+private:
+    void computeTiles(int nSteps, Config values);
+
+    chaosAttractorClass *source;
+    lyapunovMapAxis axisX, axisY;
+    vector<float> map;
+
+    std::atomic<int> nextTile;
+};
+
+//  Points archive (.cpz): orbit points quantized on a grid of step 2 * max
+//  error, from origin of the bounding box of first block (or set w/ setBox)
+//  Consecutive points are coherent: each component is predicted from previous
+//  points, w/ delta or linear extrapolation, w also as distance from previous
+//  point (best predictor chosen for each block and component), and the
+//  residuals are Rice coded in independent blocks of ARCHIVE_BLOCK points,
+//  indexed in the footer: blocks are decoded in parallel
+//  Non-finite values are stored as the predicted one
+////////////////////////////////////////////////////////////////////////////
+#define ARCHIVE_BLOCK 65536
+#define ARCHIVE_MAGIC "CHPZ"
+#define ARCHIVE_VERSION 1
+
+struct archiveHeader {
+    char magic[4];
+    uint32_t version;
+    float origin[4], step[4];
+};
+static_assert(sizeof(archiveHeader) == 40, "archiveHeader: no padding allowed");
+
+struct archiveFooter {
+    uint64_t count, indexOffset;        // index: nBlocks file offsets (uint64)
+    uint32_t nBlocks, blockSize;
+    float bMin[4], bMax[4];             // bounds of finite points
+    char magic[4];
+    uint32_t reserved;
+};
+static_assert(sizeof(archiveFooter) == 64, "archiveFooter: no padding allowed");
+
+class pointsArchiveWriter
+{
+public:
+    //relError: max error relative to bounding box size; file is not closed
+    bool open(FILE *f, float relError);
+    //quantization box, before first write (else box of first block)
+    void setBox(const vec4 &vMin, const vec4 &vMax) { boxMin = vMin; boxMax = vMax; hasBox = true; }
+    bool write(const float *pts, uint n);
+    //last block, index and footer
+    bool close();
+
+    uint64_t getCount() { return count; }
+    uint64_t getBytes() { return offset; }
+
+private:
+    bool writeHeader(const float *pts, uint n);
+    bool writeBlock(const float *pts, uint n);
+
+    FILE *file = nullptr;
+    float relError = 0.f;
+    bool hasBox = false;
+    vec4 boxMin, boxMax, origin, step, invStep;
+    vec4 vMin, vMax;
+    vector<float> pending;
+    vector<int32_t> quantized;
+    vector<uint8_t> encoded;
+    vector<uint64_t> index;
+    uint64_t count = 0, offset = 0;
+};
+
+//  Archive in memory (mapped file): decodeBlock can be called from any thread
+class pointsArchiveReader
+{
+public:
+    //false if not a valid archive
+    bool open(const uint8_t *data, uint64_t size);
+
+    uint64_t getCount() { return footer.count; }
+    int getNumBlocks() { return int(footer.nBlocks); }
+    uint64_t getBlockFirst(int b) { return uint64_t(b) * footer.blockSize; }
+    uint getBlockSize(int b) { return uint(std::min(uint64_t(footer.blockSize), footer.count - getBlockFirst(b))); }
+    vec4 getBoundsMin() { return glm::make_vec4(footer.bMin); }
+    vec4 getBoundsMax() { return glm::make_vec4(footer.bMax); }
+
+    //first n points of block b to dst (float4): false if corrupted
+    bool decodeBlock(int b, float *dst, uint n) const;
+
+private:
+    const uint8_t *data = nullptr;
+    uint64_t blockOffset(int b) const { uint64_t o; memcpy(&o, data + footer.indexOffset + uint64_t(b)*sizeof(o), sizeof(o)); return o; }
+
+    archiveHeader header;
+    archiveFooter footer;
+};
@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+////////////////////////////////////////////////////////////////////////////////
+//  chaosGen: headless points generator
+//
+//  Loads an attractor file (.sca / .chatt) and streams N points, w/o any
+//  OpenGL / GLFW / ImGui dependency.
+//
+//  Output: raw binary stream, native endian float32, 4 values for each
+//  point: x, y, z, distance from previous point (same layout of the VBO)
+//  or compressed points archive (-archive: see pointsArchiveWriter)
+////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#ifdef _WIN32
+    #include <io.h>
+    #include <fcntl.h>
+#endif
+
+#include "chaosCore.h"
+
+// points for each write
+#define CHAOSGEN_CHUNK (1024*1024)
+
+void usage()
+{
+    cerr << "usage: chaosGen attractorFile [options]" << endl
+         << "    -n  numPoints  : points to generate (default 1000000)" << endl
+         << "    -o  outFile    : output file, \"-\" for stdout (default)" << endl
+         << "    -orbits N      : multi-orbit emission, 1.." << MULTI_ORBIT_MAX << " (default 1)" << endl
+         << "    -skip numPoints: points to discard before output (default 0)" << endl
+         << "    -math precision: exact, fast, fastest sin/cos/... (default from file)" << endl
+         << "    -int method    : euler, rk4, rk45, leapfrog for d/dt attractors (default from file)" << endl
+         << "    -dt step       : time step for d/dt attractors (default from file)" << endl
+         << "    -arc length    : d/dt attractors, a point each arc length (0: each step)" << endl
+         << "    -seed N        : parameters regenerated from seed N (\"seed\" of found attractors)" << endl
+         << "    -stats         : bounds, centroid and speed percentiles of output points to stderr" << endl
+         << "    -archive error : compressed archive (.cpz), max error relative to bounds (e.g. 1e-5)" << endl
+         << endl
+         << "output: float32 x, y, z, distance for each point" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc<2) { usage(); return 1; }
+
+    const char *attFile = argv[1];
+    const char *outFile = "-";
+    uint64_t nPoints = 1000000, nSkip = 0;
+    int nOrbits = 1, mathPrecision = -1, integrator = -1;
+    float dtStep = 0.f, arcLength = -1.f, archiveError = 0.f;
+    uint32_t seed = 0;
+    bool printStats = false;
+
+    for(int i=2; i<argc; i++) {
+        const bool hasArg = i+1<argc;
+        if     (!strcmp(argv[i], "-n"     ) && hasArg) nPoints = strtoull(argv[++i], nullptr, 10);
+        else if(!strcmp(argv[i], "-skip"  ) && hasArg) nSkip   = strtoull(argv[++i], nullptr, 10);
+        else if(!strcmp(argv[i], "-o"     ) && hasArg) outFile = argv[++i];
+        else if(!strcmp(argv[i], "-orbits") && hasArg) nOrbits = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-math"  ) && hasArg) {
+            const char *p = argv[++i];
+            if     (!strcmp(p, "exact"  )) mathPrecision = attMathExact;
+            else if(!strcmp(p, "fast"   )) mathPrecision = attMathFast;
+            else if(!strcmp(p, "fastest")) mathPrecision = attMathFastest;
+            else { usage(); return 1; }
+        }
+        else if(!strcmp(argv[i], "-int"   ) && hasArg) {
+            const char *p = argv[++i];
+            if     (!strcmp(p, "euler"   )) integrator = dtIntEuler;
+            else if(!strcmp(p, "rk4"     )) integrator = dtIntRK4;
+            else if(!strcmp(p, "rk45"    )) integrator = dtIntRK45;
+            else if(!strcmp(p, "leapfrog")) integrator = dtIntLeapfrog;
+            else { usage(); return 1; }
+        }
+        else if(!strcmp(argv[i], "-dt"    ) && hasArg) dtStep = strtof(argv[++i], nullptr);
+        else if(!strcmp(argv[i], "-arc"   ) && hasArg) arcLength = strtof(argv[++i], nullptr);
+        else if(!strcmp(argv[i], "-seed"  ) && hasArg) seed = uint32_t(strtoul(argv[++i], nullptr, 10));
+        else if(!strcmp(argv[i], "-stats" )) printStats = true;
+        else if(!strcmp(argv[i], "-archive") && hasArg) {
+            archiveError = strtof(argv[++i], nullptr);
+            if(!(archiveError>0.f && archiveError<1.f)) { usage(); return 1; }
+        }
+        else { usage(); return 1; }
+    }
+
+    const bool toStdout = !strcmp(outFile, "-");
+    // stdout is reserved to points data: diagnostics of attractors code to stderr
+    if(toStdout) cout.rdbuf(cerr.rdbuf());
+
+    chaosAttractorClass *att = chaosAttractorClass::newAttractorFromFile(attFile);
+    if(att == nullptr) {
+        cerr << "chaosGen: " << attFile << " is not a valid attractor file" << endl;
+        return 1;
+    }
+
+    if(seed) att->newRandomValues(seed);
+    att->setOrbits(nOrbits);
+    if(mathPrecision>=0) att->setMathPrecision(mathPrecision);
+    if(att->dtType()) {
+        if(integrator>=0) att->setIntegrator(integrator);
+        if(dtStep>0.f) att->setDtStepInc(dtStep);
+        if(arcLength>=0.f) att->setArcLength(arcLength);
+    }
+
+#ifdef _WIN32
+    if(toStdout) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    FILE *f = toStdout ? stdout : fopen(outFile, "wb");
+    if(f == nullptr) {
+        cerr << "chaosGen: can't open " << outFile << endl;
+        return 1;
+    }
+
+    vector<float> buffer(CHAOSGEN_CHUNK*4);
+    emissionStats stats;
+    pointsArchiveWriter archive;
+    if(archiveError>0.f) archive.open(f, archiveError);
+
+    auto generate = [&] (uint64_t n, bool write) -> bool {
+        while(n) {
+            const uint nStep = uint(std::min(n, uint64_t(CHAOSGEN_CHUNK)));
+            att->fill(buffer.data(), nStep);
+            if(write && printStats) stats.accumulate(buffer.data(), nStep);
+            if(write && (archiveError>0.f ? !archive.write(buffer.data(), nStep) :
+                                            fwrite(buffer.data(), sizeof(float)*4, nStep, f) != nStep)) return false;
+            n -= nStep;
+        }
+        return true;
+    };
+
+    generate(nSkip, false);
+    const bool ok = generate(nPoints, true) && (archiveError<=0.f || archive.close());
+
+    if(!toStdout) fclose(f);
+    else fflush(f);
+
+    delete att;
+
+    if(printStats) {
+        const vec3 c = stats.getCentroid();
+        cerr << "points:   " << stats.count << endl
+             << "min:      " << stats.vMin.x << " " << stats.vMin.y << " " << stats.vMin.z << endl
+             << "max:      " << stats.vMax.x << " " << stats.vMax.y << " " << stats.vMax.z << endl
+             << "centroid: " << c.x << " " << c.y << " " << c.z << endl
+             << "speed:    p05 " << stats.getSpeedPercentile(.05f) << " p50 " << stats.getSpeedPercentile(.5f)
+             << " p95 " << stats.getSpeedPercentile(.95f) << " max " << stats.speedMax << endl;
+    }
+
+    if(!ok) {
+        cerr << "chaosGen: write error" << endl;
+        return 1;
+    }
+
+    return 0;
+}
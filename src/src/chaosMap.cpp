@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+////////////////////////////////////////////////////////////////////////////////
+//  chaosMap: Lyapunov parameter-space maps
+//
+//  Loads an attractor file (.sca / .chatt) and computes the largest
+//  Lyapunov exponent over a grid of values of two coefficients, w/o any
+//  OpenGL / GLFW / ImGui dependency.
+//
+//  Output: .csv (a line for each row) or .pfm (float image), NaN cells
+//  are divergent orbits
+////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#include "chaosCore.h"
+
+void usage()
+{
+    cerr << "usage: chaosMap attractorFile -x row col min max -y row col min max [options]" << endl
+         << "    -x, -y         : coefficient kVal[row][col] on map axes (col ignored for scalar coefficients)" << endl
+         << "    -size W H      : map size (default 256 256)" << endl
+         << "    -steps N       : exponent iterations for each cell (default 2000)" << endl
+         << "    -threads N     : worker threads (default all cores)" << endl
+         << "    -o outFile     : .csv or .pfm (default map.pfm)" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc<2) { usage(); return 1; }
+
+    const char *attFile = argv[1];
+    const char *outFile = "map.pfm";
+    lyapunovMapAxis axisX, axisY;
+    bool hasX = false, hasY = false;
+    int nSteps = 2000, nThreads = 0;
+
+    auto axisArgs = [&] (int &i, lyapunovMapAxis &a) {
+        a.row = atoi(argv[++i]); a.col = atoi(argv[++i]);
+        a.min = strtof(argv[++i], nullptr); a.max = strtof(argv[++i], nullptr);
+    };
+
+    for(int i=2; i<argc; i++) {
+        const int nArgs = argc-i-1;
+        if     (!strcmp(argv[i], "-x"      ) && nArgs>=4) { axisArgs(i, axisX); hasX = true; }
+        else if(!strcmp(argv[i], "-y"      ) && nArgs>=4) { axisArgs(i, axisY); hasY = true; }
+        else if(!strcmp(argv[i], "-size"   ) && nArgs>=2) { axisX.size = atoi(argv[++i]); axisY.size = atoi(argv[++i]); }
+        else if(!strcmp(argv[i], "-steps"  ) && nArgs>=1) nSteps   = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-threads") && nArgs>=1) nThreads = atoi(argv[++i]);
+        else if(!strcmp(argv[i], "-o"      ) && nArgs>=1) outFile  = argv[++i];
+        else { usage(); return 1; }
+    }
+    if(!hasX || !hasY || axisX.size<1 || axisY.size<1) { usage(); return 1; }
+
+    // diagnostics of attractors code to stderr
+    cout.rdbuf(cerr.rdbuf());
+
+    chaosAttractorClass *att = chaosAttractorClass::newAttractorFromFile(attFile);
+    if(att == nullptr) {
+        cerr << "chaosMap: " << attFile << " is not a valid attractor file" << endl;
+        return 1;
+    }
+
+    const int nK = att->getNumElements(AttractorBase::attLoadKtVal);
+    if(axisX.row<0 || axisX.row>=nK || axisY.row<0 || axisY.row>=nK || 
+       axisX.col<0 || axisX.col>2 || axisY.col<0 || axisY.col>2) {
+        cerr << "chaosMap: coefficient out of range (rows: 0.." << nK-1 << ")" << endl;
+        return 1;
+    }
+
+    lyapunovMapClass map(att, axisX, axisY);
+
+    auto start = std::chrono::steady_clock::now();
+    map.compute(nSteps, nThreads);
+    cerr << "chaosMap: " << axisX.size << "x" << axisY.size << " in " 
+         << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s" << endl;
+
+    const size_t len = strlen(outFile);
+    const bool csv = len>4 && !strcmp(outFile+len-4, ".csv");
+    const bool ok = csv ? map.saveCSV(outFile) : map.savePFM(outFile);
+
+    delete att;
+
+    if(!ok) {
+        cerr << "chaosMap: can't write " << outFile << endl;
+        return 1;
+    }
+
+    return 0;
+}
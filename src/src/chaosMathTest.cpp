@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+//  Copyright (c) 2018 Michele Morrone
+//  All rights reserved.
+//
+//  mailto:me@michelemorrone.eu
+//  mailto:brutpitt@gmail.com
+//  
+//  https://github.com/BrutPitt
+//
+//  https://michelemorrone.eu
+//  https://BrutPitt.com
+//
+//  This software is distributed under the terms of the BSD 2-Clause license:
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//      * Redistributions of source code must retain the above copyright
+//        notice, this list of conditions and the following disclaimer.
+//      * Redistributions in binary form must reproduce the above copyright
+//        notice, this list of conditions and the following disclaimer in the
+//        documentation and/or other materials provided with the distribution.
+//   
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+//  ARE DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+//  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+//  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+//  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+//  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+//  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF 
+//  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  chaosMathTest: fast math precision check (CTest)
+//
+//  Each mathType() attractor emits CHAOSTEST_POINTS points w/ attMathExact
+//  and w/ attMathFast / attMathFastest: trajectories diverge, but bounds,
+//  centroid (relative to exact extent) and histograms (space, speed) of
+//  points must be within tolerances, histograms ones at least twice the
+//  distance between the two halves of exact points (slow d/dt orbits).
+//  Attractor data: first file (of command line) of each nameID w/ chaotic
+//  exact points, or start data (fixed points, cycles are skipped)
+////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include <set>
+
+#include "chaosCore.h"
+
+#define CHAOSTEST_POINTS  (1024*1024)
+#define CHAOSTEST_SKIP    4096
+// bounds are extremes: less stable than centroid
+#define CHAOSTEST_BOUNDS_TOLERANCE .1f
+#define CHAOSTEST_CENTROID_TOLERANCE .05f
+// histograms: L1 distance of normalized counts (0..2)
+#define CHAOSTEST_HIST_TOLERANCE .1f
+#define CHAOSTEST_GRID 8
+// exact extent under this (relative to coords): fixed point or cycle
+#define CHAOSTEST_MIN_EXTENT 1.e-3f
+
+struct mathSample {
+    emissionStats stats;
+    vector<uint64_t> grid, half[2];
+};
+
+//attractor from file, or start data of nameID
+static chaosAttractorClass *newTestAttractor(const string &src, bool isFile)
+{
+    return isFile ? chaosAttractorClass::newAttractorFromFile(src.c_str()) : chaosAttractorClass::newAttractor(src);
+}
+
+static float maxComponent(const vec3 &v) { return std::max(v.x, std::max(v.y, v.z)); }
+
+//points w/ precision, space histograms (whole, halves) in box of exact points
+//(own box for exact): false if points are not finite
+static bool runMath(const string &src, bool isFile, int precision, mathSample &s, const emissionStats *box)
+{
+    chaosAttractorClass *att = newTestAttractor(src, isFile);
+    att->setMathPrecision(precision);
+
+    vector<float> buffer(CHAOSTEST_POINTS*4);
+    att->fill(buffer.data(), CHAOSTEST_SKIP);
+    att->fill(buffer.data(), CHAOSTEST_POINTS);
+    delete att;
+
+    s.stats.accumulate(buffer.data(), CHAOSTEST_POINTS);
+    if(s.stats.samples*STATS_STRIDE < CHAOSTEST_POINTS) return false;
+
+    const emissionStats &b = box ? *box : s.stats;
+    const vec3 scale = float(CHAOSTEST_GRID) / max(b.vMax - b.vMin, vec3(FLT_EPSILON));
+    for(auto &h : s.half) h.assign(CHAOSTEST_GRID*CHAOSTEST_GRID*CHAOSTEST_GRID, 0);
+    for(uint i=0; i<CHAOSTEST_POINTS; i++) {
+        const ivec3 c = clamp(ivec3((glm::make_vec3(buffer.data() + i*4) - b.vMin) * scale), ivec3(0), ivec3(CHAOSTEST_GRID-1));
+        s.half[i >= CHAOSTEST_POINTS/2][(c.z*CHAOSTEST_GRID + c.y)*CHAOSTEST_GRID + c.x]++;
+    }
+    s.grid = s.half[0];
+    for(size_t i=0; i<s.grid.size(); i++) s.grid[i] += s.half[1][i];
+    return true;
+}
+
+//L1 distance of normalized histograms a and b
+template <class T> static float histDistance(const T *a, const T *b, int n)
+{
+    double totA = 0, totB = 0, dist = 0;
+    for(int i=0; i<n; i++) { totA += a[i]; totB += b[i]; }
+    if(!totA || !totB) return 2.f;
+    for(int i=0; i<n; i++) dist += std::abs(a[i]/totA - b[i]/totB);
+    return float(dist);
+}
+
+int main(int argc, char **argv)
+{
+    // files, then start data of all attractors
+    vector<std::pair<string, bool>> sources;
+    for(int i=1; i<argc; i++) sources.emplace_back(argv[i], true);
+    for(const string &name : chaosAttractorClass::getNameIDs()) sources.emplace_back(name, false);
+
+    std::set<string> mathNames, testedNames;
+    int tested = 0, failed = 0;
+    for(const auto &src : sources) {
+        chaosAttractorClass *att = newTestAttractor(src.first, src.second);
+        if(att == nullptr) { printf("%s: not a valid attractor file, skipped\n", src.first.c_str()); continue; }
+        const string name = att->getNameID();
+        const bool isMath = att->mathType();
+        delete att;
+        if(!isMath || testedNames.count(name)) continue;
+        mathNames.insert(name);
+
+        mathSample exact;
+        if(!runMath(src.first, src.second, attMathExact, exact, nullptr)) continue;
+        const vec3 ext = exact.stats.vMax - exact.stats.vMin;
+        const float coordMax = maxComponent(max(abs(exact.stats.vMin), abs(exact.stats.vMax)));
+        if(maxComponent(ext) < CHAOSTEST_MIN_EXTENT * std::max(coordMax, 1.f)) continue;
+        testedNames.insert(name);
+
+        const string label = name + (src.second ? " (" + src.first.substr(src.first.find_last_of("/\\") + 1) + ")" : " (start data)");
+        const vec3 extDiv = max(ext, vec3(maxComponent(ext) * CHAOSTEST_MIN_EXTENT));
+        const float histTolerance = std::max(CHAOSTEST_HIST_TOLERANCE, 
+                                             2.f * histDistance(exact.half[0].data(), exact.half[1].data(), int(exact.grid.size())));
+        for(int precision : { attMathFast, attMathFastest }) {
+            mathSample fast;
+            bool ok = runMath(src.first, src.second, precision, fast, &exact.stats);
+
+            float dBounds = 0.f, dCentroid = 0.f, dSpace = 2.f, dSpeed = 2.f;
+            if(ok) {
+                dBounds = std::max(maxComponent(abs(fast.stats.vMin - exact.stats.vMin) / extDiv), 
+                                   maxComponent(abs(fast.stats.vMax - exact.stats.vMax) / extDiv));
+                dCentroid = maxComponent(abs(fast.stats.getCentroid() - exact.stats.getCentroid()) / extDiv);
+                dSpace = histDistance(fast.grid.data(), exact.grid.data(), int(exact.grid.size()));
+                dSpeed = histDistance(fast.stats.hist, exact.stats.hist, STATS_HIST_BINS);
+                ok = dBounds <= CHAOSTEST_BOUNDS_TOLERANCE && dCentroid <= CHAOSTEST_CENTROID_TOLERANCE && 
+                     dSpace <= histTolerance && dSpeed <= histTolerance;
+            }
+            printf("%-36s %-7s bounds %.4f centroid %.4f space %.4f speed %.4f (max %.2f) %s\n", label.c_str(), 
+                   precision == attMathFast ? "fast" : "fastest", dBounds, dCentroid, dSpace, dSpeed, histTolerance, ok ? "ok" : "FAILED");
+            tested++;
+            if(!ok) failed++;
+        }
+    }
+
+    for(const string &name : mathNames) 
+        if(!testedNames.count(name)) printf("%s: no chaotic data, skipped\n", name.c_str());
+
+    printf("%d tests, %d failed\n", tested, failed);
+    return failed || !tested ? 1 : 0;
+}
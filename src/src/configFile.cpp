@@ -41,7 +41,6 @@
 #include "glApp.h"
 #include "glWindow.h"
 
-#define CONFIGURU_IMPLEMENTATION 
 #include "libs/configuru/configuru.hpp"
 
 #include "libs/tinyFileDialog/tinyfiledialogs.h"
@@ -66,7 +65,8 @@ void writeAPalette(const char *filename, int idx)
 {
         std::ostringstream sout;
 
-        cmContainerClass cm;
+        std::shared_ptr<cmContainerClass> store = cmContainerClass::getShared();
+        cmContainerClass &cm = *store;
 
         sout.setf(sout.fixed);
         sout.precision(5);
@@ -570,6 +570,9 @@ void mainGLApp::saveProgConfig()
     cfg["vSync" ] = theApp->getVSync();
 
     cfg["maxParticles" ] = getMaxAllocatedBuffer();
+    cfg["multiOrbits" ] = attractorsList.getOrbits().getOrbits();
+    cfg["emitThreads" ] = getEmitThreads();
+    cfg["vertexFormat" ] = getVertexFormat();
     cfg["capturePath" ] = capturePath;
 
     dump_file(filename, cfg, JSON);
@@ -621,6 +624,9 @@ bool mainGLApp::loadProgConfig()
     vSync = cfg.get_or("vSync", vSync);
 
     setMaxAllocatedBuffer(cfg.get_or("maxParticles", getMaxAllocatedBuffer()));
+    attractorsList.getOrbits().setOrbits(cfg.get_or("multiOrbits", attractorsList.getOrbits().getOrbits()));
+    setEmitThreads(cfg.get_or("emitThreads", getEmitThreads()));
+    setVertexFormat(cfg.get_or("vertexFormat", getVertexFormat()));
 
     capturePath = cfg.get_or("capturePath", capturePath);
 
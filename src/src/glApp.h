@@ -248,6 +248,12 @@ public:
     int getMaxAllocatedBuffer() { return maxAllocatedBuffer; }
     void setMaxAllocatedBuffer(int v) { maxAllocatedBuffer = v; }
 
+    int getEmitThreads() { return emitThreads; }
+    void setEmitThreads(int v) { emitThreads = v<1 ? 1 : v; }
+
+    int getVertexFormat() { return vertexFormat; }
+    void setVertexFormat(int v) { vertexFormat = v; }
+
     void setVSync(int v) { vSync = v; }
     int getVSync() { return vSync; }
 
@@ -296,6 +302,8 @@ private:
     int getModifier();
 
     int maxAllocatedBuffer = ALLOCATED_BUFFER;
+    int emitThreads = 1;
+    int vertexFormat = 0; // vertexFormat enum (attractorsBase.h)
 
     int screenShotRequest;
     int vSync = 0;
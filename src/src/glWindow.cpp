@@ -45,6 +45,8 @@
 #include "glWindow.h"
 #include "ParticlesUtils.h"
 
+void updatePlyExport();
+
 //Random numbers of particle velocity of fragmentation
 RandomTexture rndTexture;
 HLSTexture hlsTexture;
@@ -228,6 +230,10 @@ void glWindow::onExit()
 ////////////////////////////////////////////////////////////////////////////
 void glWindow::onRender()
 {
+    //  background PLY export: read back of snapshot chunks
+    //////////////////////////////////////////////////////////////////
+    updatePlyExport();
+
     //  render ColorMaps: rebuild texture only if settings are changed
     //////////////////////////////////////////////////////////////////
     particlesSystem->shaderPointClass::getCMSettings()->render();
@@ -329,6 +335,7 @@ void glWindow::DrawOnTexture()
 ////////////////////////////////////////////////////////////////////////////
 void glWindow::onIdle()
 {
+    attractorsList.checkNewRandom();
     particlesSystem->getTMat()->getTrackball().idle();
 }
 
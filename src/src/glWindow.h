@@ -144,6 +144,9 @@ public:
         //setParticlesCount(0L);
         setSizeStepBuffer(EMISSION_STEP);    
         setEmitterOff();
+        const int fmt = theApp->getVertexFormat();
+        packing.format = (fmt<vtxFmtFloat || fmt>=vtxFmtNum) ? vtxFmtFloat : fmt;
+        requestFit();
     }
 
     virtual void resetVBOindexes() {
@@ -164,18 +167,41 @@ public:
 
 #if !defined(USE_MAPPED_BUFFER) 
     #ifdef USE_THREAD_TO_FILL 
-            bool bufferFull = InsertVbo->uploadSubBuffer(attractorsList.get()->getEmittedParticles(), szCircularBuffer);
+            // upload blocks ready, never wait: step thread waits only if all are ready
+            const bool wasFull = !InsertVbo->isStagingFree();
+            bool bufferFull = InsertVbo->uploadStaging(szCircularBuffer);
+            if(wasFull) attractorsList.getThreadStep()->notify();
+            if(bufferFull && restartCircBuff()) {
+                resetVBOindexes();
+                needRestartCircBuffer(true);
+            } 
+            if(bufferFull && stopFull()) {
+                setEmitterOff();
+            }
     #else
             GLfloat *ptrBuff = InsertVbo->getBuffer();
-            attractorsList.get()->Step(ptrBuff, getSizeStepBuffer());
+            float *stepBuff = ptrBuff;
+            if(packing.isPacked()) {
+                stepScratch.resize(getSizeStepBuffer()*4);
+                stepBuff = stepScratch.data();
+            }
+            // dead orbit and no more reseeds: pause emission, nothing uploaded
+            if(!attractorsList.Step(stepBuff, getSizeStepBuffer())) {
+                setEmitterOff();
+                return;
+            }
+            attractorsList.get()->getStats().accumulate(stepBuff, getSizeStepBuffer());
+            vec4 bMin, bMax;
+            if(packing.isPacked() && !packing.pack(stepScratch.data(), ptrBuff, getSizeStepBuffer(), &bMin, &bMax)) 
+                requestRefit(bMin, bMax);
             bool bufferFull = InsertVbo->uploadSubBuffer(szStepBuffer, szCircularBuffer);
-    #endif
             if(bufferFull && stopFull()) {
                 setEmitterOff();
             }
             if(bufferFull && restartCircBuff()) {
                 needRestartCircBuffer(true);
             } 
+    #endif
 #else
             //Alredy GL_MAP_COHERENT_BIT
             //glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
@@ -199,25 +225,67 @@ public:
 
     bool loopCanStart() { 
 #ifdef USE_MAPPED_BUFFER
-        const bool retVal = isEmitterOn() || !attractorsList.getEndlessLoop();
+        return isEmitterOn() && !isFitPending() && !needRestartCircBuffer() && InsertVbo->isWritable() || !attractorsList.getEndlessLoop();
 #else
-        const bool retVal = (bBufferRendered && isEmitterOn() || !attractorsList.getEndlessLoop());
-        bufferRendered(false);
+        return isEmitterOn() && !isFitPending() && InsertVbo->isStagingFree() || !attractorsList.getEndlessLoop();
 #endif
-        return retVal;
     }
 
-    void bufferRendered(bool b=true) { bBufferRendered = b; }
-    bool isBufferRendered() { return bBufferRendered; }
-
-    bool stopLoop() { return bStopLoop; }
-    void stopLoop(bool b) { bStopLoop = b; }
+    // vertex format: quantization box is fitted by render loop from current
+    // attractor point, step thread waits for it (emission start, or points
+    // out of box: box grown to them, emitted points restarted)
+    vertexPacking &getPacking() { return packing; }
+    void requestFit() { 
+        std::lock_guard<std::mutex> lock(refitMutex);
+        refitPending = false;
+        fitPending = packing.isPacked(); 
+    }
+    //points clamped in bounds bMin/bMax (step workers or render loop)
+    void requestRefit(const vec4 &bMin, const vec4 &bMax) {
+        std::lock_guard<std::mutex> lock(refitMutex);
+        refitMin = refitPending ? min(refitMin, bMin) : bMin;
+        refitMax = refitPending ? max(refitMax, bMax) : bMax;
+        refitPending = true;
+        fitPending.store(true, std::memory_order_release);
+    }
+    //box already set (imported points)
+    void cancelFit() { 
+        std::lock_guard<std::mutex> lock(refitMutex);
+        refitPending = false;
+        fitPending = false; 
+    }
+    bool isFitPending() { return fitPending.load(std::memory_order_acquire); }
+    //imported points w/ rgb colors in w (bits of unorm 4x8), not speed
+    bool hasColorData() { return bColorData; }
+    void setColorData(bool b) { bColorData = b; }
+    void checkFit() {
+        if(!isFitPending()) return;
+        std::unique_lock<std::mutex> lock(refitMutex);
+        if(refitPending) {
+            // step thread stops at next batch: box is changed when it's idle
+            if(!isLoopStopped()) return;
+            const vec4 bMin = refitMin, bMax = refitMax;
+            lock.unlock();
+            // emitted points are packed in old box
+            attractorsList.getThreadStep()->restartEmitter();
+            packing.extend(bMin, bMax);
+        } else {
+            lock.unlock();
+            packing.fit(attractorsList.get(), attractorsList.get()->getCurrent());
+        }
+        fitPending.store(false, std::memory_order_release);
+#ifdef USE_THREAD_TO_FILL
+        attractorsList.getThreadStep()->notify();
+#endif
+    }
 
 
-    bool isEmitterOn() { return bEmitter; }
+    bool isEmitterOn() { return bEmitter.load(std::memory_order_acquire); }
     void setEmitter(bool emit) 
     { 
-        bEmitter = emit;
+        // new emission: reseeds budget for dead orbits
+        if(emit) attractorsList.resetHealth();
+        bEmitter.store(emit, std::memory_order_release);
 #ifdef USE_THREAD_TO_FILL
         attractorsList.getThreadStep()->notify();
 #endif
@@ -236,8 +304,8 @@ public:
 
     vtxBUFFER *getVBO() { return InsertVbo; }
 
-    void setThreadRunning(bool b) { threadRunning=b; }
-    bool getThreadRunning() { return threadRunning; }
+    void setThreadRunning(bool b) { threadRunning.store(b, std::memory_order_release); }
+    bool getThreadRunning() { return threadRunning.load(std::memory_order_acquire); }
     bool isLoopRunning() { return getThreadRunning(); }
     bool isLoopStopped() { return !getThreadRunning(); }
 
@@ -249,15 +317,23 @@ protected:
     GLuint szAllocatedBuffer ;
     GLuint szCircularBuffer;
     GLuint szStepBuffer;
-    bool bEmitter = false; 
+    std::atomic<bool> bEmitter { false }; 
     bool bStopFull = false, bRestartCircBuff = false;
-    
-    bool bBufferRendered = false, bStopLoop = false;
 
     vtxBUFFER *InsertVbo;
 
-    bool threadRunning=false;
-    bool needRestartBuffer = false;
+    std::atomic<bool> threadRunning { false };
+    std::atomic<bool> needRestartBuffer { false };
+
+    vertexPacking packing;
+    std::atomic<bool> fitPending { false };
+    std::mutex refitMutex;
+    bool refitPending = false;
+    vec4 refitMin, refitMax;
+    bool bColorData = false;
+#if !defined(USE_THREAD_TO_FILL) 
+    std::vector<float> stepScratch;
+#endif
 
 };
 
@@ -265,7 +341,13 @@ class singleEmitterClass : public emitterBaseClass
 {
 public:
     singleEmitterClass() {
+#if defined(USE_THREAD_TO_FILL) && !defined(USE_MAPPED_BUFFER)
+        InsertVbo = new vtxBUFFER(GL_POINTS, getSizeStepBuffer(), 1, STAGING_BLOCKS);
+#else
         InsertVbo = new vtxBUFFER(GL_POINTS, getSizeStepBuffer(), 1);
+#endif
+        if(packing.format == vtxFmtHalf)    InsertVbo->setAttribFormat(GL_HALF_FLOAT, GL_FALSE);
+        if(packing.format == vtxFmtUnorm16) InsertVbo->setAttribFormat(GL_UNSIGNED_SHORT, GL_TRUE);
         InsertVbo->initBufferStorage(getSizeAllocatedBuffer());
     }
 
@@ -275,24 +357,22 @@ public:
     { 
         if(isEmitterOn()) 
         {
+            checkFit();
 #if !defined(USE_MAPPED_BUFFER)
-    #ifdef USE_THREAD_TO_FILL
-            stopLoop(true);
-            while(isLoopRunning()) attractorsList.getThreadStep()->notify();
-
-            storeData();
-            stopLoop(false);
-            bufferRendered();
-            attractorsList.get()->resetEmittedParticles();
-            attractorsList.getThreadStep()->notify();
-    #else
             storeData();
-    #endif
 #else
-            //attractorsList.getThreadStep()->notify();
+            // restart requested by step thread at end of circular buffer
+            if(needRestartCircBuffer()) {
+                resetVBOindexes();
+                needRestartCircBuffer(false);
+                attractorsList.getThreadStep()->notify();
+            }
+            if(InsertVbo->updateWriteRange(szCircularBuffer)) attractorsList.getThreadStep()->notify();
 #endif
         }
-
+#ifdef USE_THREAD_TO_FILL
+        attractorsList.getThreadStep()->collectStats();
+#endif
     }
 
     void renderEvents() {
@@ -301,7 +381,9 @@ public:
 
     virtual void postRenderEvents() 
     {
-        
+#ifdef USE_MAPPED_BUFFER
+        InsertVbo->fenceFrame();
+#endif
     }
  
 };
@@ -482,7 +564,6 @@ public:
         } else {
             shaderBillboardClass::render(getRenderFBO().getFB(0), getEmitter());
             shaderPointClass::render(getRenderFBO().getFB(1), getEmitter());
-            emitter->bufferRendered();
             //setViewOrtho();
             shaderBillboardClass::getGlowRender()->render(getRenderFBO().getTex(0), shaderBillboardClass::getGlowRender()->getFBO().getFB(1));  
             shaderPointClass::getGlowRender()->render(getRenderFBO().getTex(1), shaderPointClass::getGlowRender()->getFBO().getFB(1));  
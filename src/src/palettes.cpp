@@ -33,6 +33,11 @@
 //  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //
 ////////////////////////////////////////////////////////////////////////////////
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+
 #include "palettes.h"
 CMap3 cm_magma =     {  0.001462f, 0.000466f, 0.013866f,
                         0.002258f, 0.001295f, 0.018331f,
@@ -1611,4 +1616,118 @@ Parula = [[0.2081, 0.1663, 0.5292], [0.2116238095, 0.1897809524, 0.5776761905],
  [0.9697, 0.8481380952, 0.147452381], [0.9625857143, 0.8705142857, 0.1309], 
  [0.9588714286, 0.8949, 0.1132428571], [0.9598238095, 0.9218333333, 
   0.0948380952], [0.9661, 0.9514428571, 0.0755333333], 
- [0.9763, 0.9831, 0.0538]] */
\ No newline at end of file
+ [0.9763, 0.9831, 0.0538]] */
+
+//  Palettes cache: paletteCacheHeader, then type, name and rgbData lengths
+//  (uint32) and chars of each palette, then rgbData (float) of all palettes
+////////////////////////////////////////////////////////////////////////////
+#define PALETTES_CACHE_MAGIC "CHPL"
+#define PALETTES_CACHE_VERSION 1
+
+struct paletteCacheHeader {
+    char magic[4];
+    uint32_t version;
+    int64_t mTime;                  // JSON file modification time and size
+    uint64_t size;
+    uint32_t count, reserved;
+};
+
+std::shared_ptr<cmContainerClass> cmContainerClass::getShared()
+{
+    static std::weak_ptr<cmContainerClass> shared;
+    std::shared_ptr<cmContainerClass> store = shared.lock();
+    if(!store) shared = store = std::make_shared<cmContainerClass>();
+    return store;
+}
+
+bool cmContainerClass::loadCachedColorMaps(const char *filename)
+{
+    struct stat st;
+    if(stat(filename, &st)) return false;
+
+    cacheName = std::string(filename) + PALETTES_CACHE_EXT;
+    if(readCache(cacheName.c_str(), int64_t(st.st_mtime), uint64_t(st.st_size))) return true;
+
+    if(!loadColorMaps(filename)) return false;
+    writeCache(cacheName.c_str(), int64_t(st.st_mtime), uint64_t(st.st_size));
+    return true;
+}
+
+bool cmContainerClass::readCache(const char *filename, int64_t mTime, uint64_t size)
+{
+    FILE *f = fopen(filename, "rb");
+    if(f == nullptr) return false;
+
+    paletteCacheHeader hdr;
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 && !memcmp(hdr.magic, PALETTES_CACHE_MAGIC, 4) &&
+              hdr.version == PALETTES_CACHE_VERSION && hdr.mTime == mTime && hdr.size == size;
+
+    vector<string> fileTypes, fileNames;
+    vector<cachedCMap> fileData;
+    for(uint32_t i=0; ok && i<hdr.count; i++) {
+        uint32_t len[3];        // type, name, rgbData
+        ok = fread(len, sizeof(len), 1, f) == 1 && len[0] < 4096 && len[1] < 4096;
+        if(!ok) break;
+        string t(len[0], ' '), n(len[1], ' ');
+        ok = fread(&t[0], 1, len[0], f) == len[0] && fread(&n[0], 1, len[1], f) == len[1];
+        fileTypes.push_back(t); fileNames.push_back(n);
+        fileData.emplace_back();
+        fileData.back().size = len[2];
+    }
+
+    // rgbData after index, up to end of file
+    uint64_t offset = ok ? uint64_t(ftell(f)) : 0;
+    for(auto &c : fileData) { c.offset = offset; offset += uint64_t(c.size) * sizeof(float); }
+    ok = ok && !fseek(f, 0, SEEK_END) && uint64_t(ftell(f)) == offset;
+    fclose(f);
+    if(!ok) return false;
+
+    type.insert(type.end(), fileTypes.begin(), fileTypes.end());
+    name.insert(name.end(), fileNames.begin(), fileNames.end());
+    cached.insert(cached.end(), fileData.begin(), fileData.end());
+    rgb.resize(name.size());
+    return true;
+}
+
+void cmContainerClass::readCachedRGB(int i)
+{
+    cachedCMap &c = cached.at(i);
+    CMap3 &data = rgb.at(i);
+    data.resize(c.size);
+
+    FILE *f = fopen(cacheName.c_str(), "rb");
+    const bool ok = f != nullptr && !fseek(f, long(c.offset), SEEK_SET) && fread(data.data(), sizeof(float), c.size, f) == c.size;
+    if(f != nullptr) fclose(f);
+    if(!ok) {
+        cout << cacheName << ": can't read palette " << name.at(i) << endl;
+        data = cm_viridis;
+    }
+    c.offset = 0;
+}
+
+//  whole store: read only folder or error, JSON parsed at each start
+void cmContainerClass::writeCache(const char *filename, int64_t mTime, uint64_t size)
+{
+    if(type.size() != name.size() || rgb.size() != name.size()) return;
+    FILE *f = fopen(filename, "wb");
+    if(f == nullptr) return;
+
+    paletteCacheHeader hdr = {};
+    memcpy(hdr.magic, PALETTES_CACHE_MAGIC, 4);
+    hdr.version = PALETTES_CACHE_VERSION;
+    hdr.mTime = mTime;
+    hdr.size = size;
+    hdr.count = uint32_t(name.size());
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    for(size_t i=0; ok && i<name.size(); i++) {
+        const uint32_t len[3] = { uint32_t(type[i].size()), uint32_t(name[i].size()), uint32_t(rgb[i].size()) };
+        ok = fwrite(len, sizeof(len), 1, f) == 1 &&
+             fwrite(type[i].data(), 1, len[0], f) == len[0] && fwrite(name[i].data(), 1, len[1], f) == len[1];
+    }
+    for(size_t i=0; ok && i<rgb.size(); i++) 
+        ok = fwrite(rgb[i].data(), sizeof(float), rgb[i].size(), f) == rgb[i].size();
+
+    ok = !fclose(f) && ok;
+    if(!ok) remove(filename);
+}
@@ -38,6 +38,7 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <memory>
 #include "ParticlesUtils.h"
 #include "libs/configuru/configuru.hpp"
 
@@ -86,7 +87,14 @@ extern CMap3 cm_deep   ;
 extern CMap3 cm_delta  ;
 */
 #define BUILT_IN_STRING "BuiltIn"
-#define PUSH_BACK(ELEM) rgb.push_back(ELEM); name.push_back(#ELEM); type.push_back(BUILT_IN_STRING);
+#define PALETTES_FILE "colorMaps/palettes.json"
+#define PALETTES_CACHE_EXT ".cache"
+#define PUSH_BACK(ELEM) rgb.push_back(ELEM); name.push_back(#ELEM); type.push_back(BUILT_IN_STRING); cached.emplace_back();
+
+//  Palettes store, one for all render paths (getShared)
+//  PALETTES_FILE is parsed only when its binary cache (PALETTES_CACHE_EXT,
+//  valid while JSON mtime and size are unchanged) is missing or stale: from
+//  cache only names are read at startup, rgbData of a palette on first use
 class cmContainerClass 
 {
 public:
@@ -94,7 +102,7 @@ public:
     
     cmContainerClass() {
         //rgb.resize(50);
-        if(!loadColorMaps("colorMaps/palettes.json")) {
+        if(!loadCachedColorMaps(PALETTES_FILE)) {
             PUSH_BACK(cm_viridis);
             PUSH_BACK(cm_parula );
             PUSH_BACK(cm_plasma );
@@ -126,12 +134,15 @@ public:
 
     }
 
+    //store alive while someone holds it (main thread only)
+    static std::shared_ptr<cmContainerClass> getShared();
+
     const char *getName(int i) { return name.at(i).c_str(); }
-    CMap3& getRGB_CMap3(int i) { return rgb.at(i); }
-    float *getRGB_pf3(int i)   { return rgb.at(i).data(); }
-    vec3 *getRGB_pv3(int i)    { return (vec3 *)rgb.at(i).data(); }
+    CMap3& getRGB_CMap3(int i) { return loadRGB(i); }
+    float *getRGB_pf3(int i)   { return loadRGB(i).data(); }
+    vec3 *getRGB_pv3(int i)    { return (vec3 *)loadRGB(i).data(); }
 
-    int elements()             { return rgb.size(); }
+    int elements()             { return name.size(); }
 
     int checkExistingName(const std::string &s)
     {
@@ -152,6 +163,7 @@ public:
             type.push_back(c.get_or("Type", "noName" ));
             name.push_back(s);
             rgb.emplace_back(CMap3());
+            cached.emplace_back();
             for (const Config& i : c["rgbData"].as_array())
                 rgb.back().push_back(i.as_float());        
             return rgb.size()-1;    // if loaded return last idx
@@ -166,6 +178,7 @@ public:
             rgb.erase(rgb.begin()+i);
             name.erase(name.begin()+i);
             type.erase(type.begin()+i);
+            cached.erase(cached.begin()+i);
         } 
     }
 
@@ -195,6 +208,7 @@ public:
                         else if((std::string)p.key() == "Name") name.push_back((std::string)p.value());
                         else if((std::string)p.key() == "rgbData" && p.value().is_array()) {
                             rgb.emplace_back(CMap3());
+                            cached.emplace_back();
 	                        for (const Config& element : p.value().as_array()) {
                                 rgb.back().push_back(element.as_float());
                             }
@@ -210,10 +224,25 @@ public:
 
     }
 
+    //filename parsed and cached, or names from its valid cache
+    bool loadCachedColorMaps(const char *filename);
+
 public:
     vector<CMap3> rgb;
     vector<string> name;
     vector<string> type;
+
+private:
+    //rgbData still in cache file: offset 0 if loaded or not cached
+    struct cachedCMap { uint64_t offset = 0; uint32_t size = 0; };
+
+    CMap3 &loadRGB(int i) { if(cached.at(i).offset) readCachedRGB(i); return rgb.at(i); }
+    void readCachedRGB(int i);
+    bool readCache(const char *filename, int64_t mTime, uint64_t size);
+    void writeCache(const char *filename, int64_t mTime, uint64_t size);
+
+    vector<cachedCMap> cached;
+    string cacheName;
 };
 
 #undef PUSH_BACK
@@ -49,19 +49,19 @@
 
 #include "uiMainDlg.h"
 
-int AttractorBase::additionalDataDlg()
+int attractorDlgClass::additionalDataDlg(AttractorBase *att)
 {
     int retVal = 0;
-    if(!dlgAdditionalDataVisible()) return 0;
+    if(!att->dlgAdditionalDataVisible()) return 0;
 
     const float border = DLG_BORDER_SIZE;
 
-    bool isVisible = dlgAdditionalDataVisible();    
+    bool isVisible = att->dlgAdditionalDataVisible();    
     ImGui::SetNextWindowSize(ImVec2(200, ImGui::GetFrameHeightWithSpacing()*5), ImGuiCond_Once);
-    if (ImGui::Begin(displayName.c_str(), &isVisible)) {
+    if (ImGui::Begin(att->getDisplayName().c_str(), &isVisible)) {
         ImVec2 startPos(ImGui::GetCursorPos());
 
-        additionalDataCtrls();
+        additionalDataCtrls(att);
 
         const ImVec2 sz = ImGui::GetContentRegionAvail();
         const float wHalf = sz.x*.5f;
@@ -69,17 +69,51 @@ int AttractorBase::additionalDataDlg()
         const float wButt2 = (wHalf-border*2);
 
         ImGui::SetCursorPos(ImGui::GetCursorStartPos()+ImVec2(border, startPos.y + sz.y));
-        if(ImGui::Button("OK",ImVec2(wButt2,0.0))) { dlgAdditionalDataVisible(false); retVal = 1; }
+        if(ImGui::Button("OK",ImVec2(wButt2,0.0))) { att->dlgAdditionalDataVisible(false); retVal = 1; }
         ImGui::SameLine(posB);
-        if(ImGui::Button("Cancel",ImVec2(wButt2,0.0))) { dlgAdditionalDataVisible(false); retVal = -1; }
+        if(ImGui::Button("Cancel",ImVec2(wButt2,0.0))) { att->dlgAdditionalDataVisible(false); retVal = -1; }
 
     } ImGui::End();
 
+    Magnetic *magnetic = dynamic_cast<Magnetic *>(att);
+    if(retVal == 1 && magnetic) {
+        attractorsList.getThreadStep()->stopThread();
+        
+        magnetic->setElements(magnetic->tmpElements);
+        attractorsList.getThreadStep()->restartEmitter();
+        attractorsList.getThreadStep()->startThread();
+    }
+
     return retVal;
 }
 
+void attractorDlgClass::additionalDataCtrls(AttractorBase *att)
+{
+    if(att->dtType()) additionalDataCtrls(static_cast<attractorDtType *>(att));
+    else if(PowerN3D *p = dynamic_cast<PowerN3D *>(att)) additionalDataCtrls(p);
+    else if(Magnetic *m = dynamic_cast<Magnetic *>(att)) additionalDataCtrls(m);
+
+    if(att->mathType()) mathPrecisionCtrls(att);
+}
+
+void attractorDlgClass::mathPrecisionCtrls(AttractorBase *att)
+{
+        const float border = DLG_BORDER_SIZE;
 
-void attractorDtType::additionalDataCtrls()
+        const float w = ImGui::GetContentRegionAvailWidth();
+        const float wCombo = (w - (border*6)) *.18;
+
+        ImGui::SameLine();
+        if(!att->dtType()) ImGui::SetCursorPosX(INDENT(border));
+
+        int i = att->getMathPrecision();
+        ImGui::PushItemWidth(wCombo);
+        if(ImGui::Combo("##mathP", &i, "Exact\0Fast\0Fastest\0")) att->setMathPrecision(i);
+        ImGui::PopItemWidth();
+}
+
+
+void attractorDlgClass::additionalDataCtrls(attractorDtType *att)
 {
         const float border = DLG_BORDER_SIZE;
 
@@ -88,18 +122,36 @@ void attractorDtType::additionalDataCtrls()
 
         ImGui::SameLine();
 
-        float f = dtStepInc;
+        float f = att->dtStepInc;
 
         ImGui::PushItemWidth(wButt);
         ImGui::SetCursorPosX(INDENT(border));     
         ImGui::AlignTextToFramePadding();
         //ImGui::TextDisabled("dt Increment");
 
-        if(ImGui::DragFloat("##dtI", &f, .000001f, 0.0, 1.0, "dt: %.8f",1.0f)) dtStepInc = f;
+        if(ImGui::DragFloat("##dtI", &f, .000001f, 0.0, 1.0, "dt: %.8f",1.0f)) att->dtStepInc = f;
+        ImGui::PopItemWidth();
+
+        const float wCombo = (w - (border*6)) *.18;
+
+        ImGui::SameLine();
+        int i = att->integrator;
+        ImGui::PushItemWidth(wCombo);
+        if(ImGui::Combo("##dtInt", &i, "Euler\0RK4\0RK45\0Leapfrog\0")) att->integrator = i;
+
+        if(att->integrator == dtIntRK45) {
+            ImGui::SameLine();
+            float tol = att->tolerance;
+            if(ImGui::DragFloat("##dtTol", &tol, 1.e-7f, 1.e-8f, 1.e-2f, "tol: %.1e",1.0f)) att->tolerance = tol;
+        }
+
+        ImGui::SameLine();
+        float arc = att->arcLength;
+        if(ImGui::DragFloat("##dtArc", &arc, .0001f, 0.0, 10.0, arc > 0.f ? "arc: %.4f" : "arc: off",1.0f)) att->arcLength = arc;
         ImGui::PopItemWidth();
 }
 
-void PowerN3D::additionalDataCtrls()
+void attractorDlgClass::additionalDataCtrls(PowerN3D *att)
 {
 
         const float border = DLG_BORDER_SIZE;
@@ -116,12 +168,12 @@ void PowerN3D::additionalDataCtrls()
         //ImGui::Text("Elements:"); 
         
         ImGui::SetCursorPosX(border);        
-        ImGui::DragInt("##or", &tmpOrder, .1, 1, 20, "Order: %03d");
+        ImGui::DragInt("##or", &att->tmpOrder, .1, 1, 20, "Order: %03d");
         ImGui::SameLine();
         if(ImGui::Button("Set", ImVec2(wButt,0.0))) {
             attractorsList.getThreadStep()->stopThread();
         
-            setOrder(tmpOrder);
+            att->setOrder(att->tmpOrder);
             attractorsList.getThreadStep()->restartEmitter();
             attractorsList.getThreadStep()->startThread();
 
@@ -131,7 +183,7 @@ void PowerN3D::additionalDataCtrls()
 }
 
 
-void Magnetic::additionalDataCtrls()
+void attractorDlgClass::additionalDataCtrls(Magnetic *att)
 {
         const float border = DLG_BORDER_SIZE;
 
@@ -147,12 +199,12 @@ void Magnetic::additionalDataCtrls()
         //ImGui::Text("Elements:"); 
         
         ImGui::SetCursorPosX(border);        
-        ImGui::DragInt("##el", &tmpElements, .1, 2, 999, "Elem: %03d");
+        ImGui::DragInt("##el", &att->tmpElements, .1, 2, 9999, "Elem: %04d");
         ImGui::SameLine();
         if(ImGui::Button("Set", ImVec2(wButt,0.0))) {
             attractorsList.getThreadStep()->stopThread();
         
-            setElements(tmpElements);
+            att->setElements(att->tmpElements);
             attractorsList.getThreadStep()->restartEmitter();
             attractorsList.getThreadStep()->startThread();
 
@@ -161,25 +213,6 @@ void Magnetic::additionalDataCtrls()
 }
 
 
-int Magnetic::additionalDataDlg()
-{
-    if(!dlgAdditionalDataVisible()) return 0;
-    
-    //ImGui::BeginPopupModal("aaa")
-    //getThreadStep()->stopStepThread();
-
-    if(AttractorBase::additionalDataDlg() == 1) {
-        attractorsList.getThreadStep()->stopThread();
-        
-        setElements(tmpElements);
-        attractorsList.getThreadStep()->restartEmitter();
-        attractorsList.getThreadStep()->startThread();
-    }
-
-    return 0;
-
-}
-
 void attractorDlgClass::view() 
 {
     if(!visible()) return;
@@ -272,7 +305,11 @@ void attractorDlgClass::view()
                     ImGui::PopItemWidth();
 
                     ImGui::SetCursorPosX(wDn-border-buttW);
-                    if(ImGui::Button(ICON_FA_RANDOM " Generate",ImVec2(buttW,0)))  attractorsList.generateNewRandom();
+                    if(!attractorsList.isNewRandomPending()) {
+                        if(ImGui::Button(ICON_FA_RANDOM " Generate",ImVec2(buttW,0)))  attractorsList.generateNewRandom();
+                    } else {
+                        if(ImGui::Button(ICON_FA_SPINNER " Cancel",ImVec2(buttW,0)))  attractorsList.cancelNewRandom();
+                    }
                 } else {
                     ImGui::AlignTextToFramePadding(); ImGui::NewLine();
                     ImGui::AlignTextToFramePadding(); ImGui::NewLine();
@@ -281,12 +318,12 @@ void attractorDlgClass::view()
 /*
                 {
                     if(ImGui::Button("AdditionalData")) attractorsList.get()->dlgAdditionalDataVisible(true);
-                    attractorsList.get()->additionalDataDlg();
+                    additionalDataDlg(attractorsList.get());
 
                 }
 */
                 ImGui::NewLine();
-                attractorsList.get()->additionalDataCtrls();
+                additionalDataCtrls(attractorsList.get());
                 ImGui::SameLine();
 
                 
@@ -52,6 +52,13 @@ int ShowStyleSelector(const float w);
 void selectTheme(int style_idx);
 
 bool loadObjFile();
+bool loadPointsFile();
+bool savePointsFile();
+bool loadPlyFile();
+bool savePlyFile(bool binary, bool colorW);
+float getPlyExportProgress();
+bool loadArchiveFile();
+bool saveArchiveFile(float relError);
 
 void saveSettingsFile();
 void loadSettingsFile();
@@ -438,6 +445,15 @@ void particlesDlgClass::viewSettings(particlesBaseClass *particles, char id)
                 ImGui::SetCursorPosX(INDENT(posA )); ImGui::TextDisabled("Range");
                 ImGui::SameLine(     INDENT(posB3)); ImGui::TextDisabled("Offset");
                 ImGui::SameLine(     INDENT(posC3)); ImGui::TextDisabled("Color Vel."); 
+                {
+                    // p95 of emitted speeds at palette end
+                    const emissionStats &stats = attractorsList.get()->getStats();
+                    ImGui::SameLine();
+                    char s[32];
+                    sprintf(s,"%s%s", "Fit", buildID(base, idA++, id));
+                    if(ImGui::SmallButton(s) && stats.samples)
+                        cmSet->setVelIntensity(glm::clamp(1.f / stats.getSpeedPercentile(.95f), .001f, 100.f));
+                }
                 
                 ImGui::PushItemWidth(wButt3);
                 {
@@ -990,7 +1006,14 @@ void particlesDlgClass::view()
                 { //Emitter
                     ImGui::SameLine(pos3); 
                     const bool b = pSys->getEmitter()->isEmitterOn();
-                    if(colCheckButton(b, b ? "Emitter " ICON_FA_TOGGLE_ON : "Emitter " ICON_FA_TOGGLE_OFF, wButt)) {pSys->getEmitter()->setEmitter(b^1); }
+                    // dead orbit: reseeded, or emission paused
+                    const int health = attractorsList.getHealth();
+                    const char *lbl = health == emitHealthy ? (b ? "Emitter " ICON_FA_TOGGLE_ON "###emit" : "Emitter " ICON_FA_TOGGLE_OFF "###emit") :
+                                                              (b ? "Emitter " ICON_FA_EXCLAMATION_TRIANGLE "###emit" : "Paused " ICON_FA_EXCLAMATION_TRIANGLE "###emit");
+                    if(colCheckButton(b, lbl, wButt)) {pSys->getEmitter()->setEmitter(b^1); }
+                    if(health != emitHealthy && ImGui::IsItemHovered())
+                        ImGui::SetTooltip("%s orbit: %d reseeds%s", health == emitDiverged ? "Diverging" : "Fixed point", 
+                                          attractorsList.getReseeds(), b ? "" : ", emission paused");
                 }
 
                 //////////Linea 2//////////
@@ -1185,6 +1208,22 @@ void viewSettingDlgClass::view()
                 tBall.setDollyPosition(vec3(0.f, 0.f, v.z));
             }
         }
+        {
+            // emitted points: target on centroid, whole box in view
+            const emissionStats &stats = attractorsList.get()->getStats();
+            if(ImGui::Button("Fit to Points", ImVec2(w,0)) && stats.samples) {
+                transformsClass *tMat = pSys->getTMat();
+                const vec3 c = stats.getCentroid();
+                const float r = std::max(length(max(abs(stats.vMax - c), abs(stats.vMin - c))), FLT_EPSILON);
+                const vec3 dir = tMat->getPOV() - tMat->getTGT();
+                const float dist = r / sin(glm::radians(tMat->getPerspAngle()) * .5f);
+                tMat->setView(c + (length(dir) > FLT_EPSILON ? normalize(dir) : vec3(0.f, 0.f, 1.f)) * dist, c);
+                tBall.setRotationCenter(c);
+                tBall.setPanPosition(vec3(0.f));
+                tBall.setDollyPosition(vec3(0.f));
+                if(tMat->getPerspFar() < dist + r) tMat->setPerspective(tMat->getPerspAngle(), tMat->getPerspNear(), dist + r);
+            }
+        }
 
         //  Gizmo
         ///////////////////////////////////////////////////////////////////////
@@ -1462,7 +1501,8 @@ void progSettingDlgClass::view()
         ImGui::SameLine(); 
         
         ImGui::PushItemWidth(wButt*.5 -ImGui::GetCursorPosX() - border);
-        static float maxBuff= theApp->getMaxAllocatedBuffer()*(.000001);
+        static float maxBuff= theApp->getMaxAllocatedBuffer()*(.000001);
+        static int vtxFormat = theApp->getVertexFormat();
         ImGui::DragFloat("##partNum",&maxBuff,0.1, 0, PARTICLES_MAX*(.000001),"%.3f M");
 
         ImGui::PopItemWidth();
@@ -1471,9 +1511,44 @@ void progSettingDlgClass::view()
         ImGui::TextDisabled("Mem req.: "); 
         ImGui::SameLine(); 
         ImGui::PushItemWidth(wButt -ImGui::GetCursorPosX());
-        ImGui::Text("%.3f GB", (maxBuff*16.f)/(1024));
+        ImGui::Text("%.3f GB", (maxBuff*(vtxFormat == vtxFmtFloat ? 16.f : 8.f))/(1024));
+
+        ImGui::PopItemWidth();
+
+        ImGui::NewLine();
+
+        ImGui::Text(" Emission");
+        ImGui::AlignTextToFramePadding();
+        ImGui::TextDisabled("Orbits:"); 
+        ImGui::SameLine(); 
+        ImGui::PushItemWidth(wButt*.5 -ImGui::GetCursorPosX() - border);
+        {
+            int nOrbits = attractorsList.getOrbits().getOrbits();
+            if(ImGui::SliderInt("##orbits", &nOrbits, 1, MULTI_ORBIT_MAX)) {
+                bool isOn = theWnd->getParticlesSystem()->getEmitter()->isEmitterOn();
+                if(isOn) attractorsList.getThreadStep()->stopThread();
+                attractorsList.getOrbits().setOrbits(nOrbits);
+                if(isOn) attractorsList.getThreadStep()->startThread();
+            }
+        }
+        ImGui::PopItemWidth();
+
+        ImGui::SameLine(wButt*.5 + border); 
+        ImGui::TextDisabled("Threads:"); 
+        ImGui::SameLine(); 
+        ImGui::PushItemWidth(wButt -ImGui::GetCursorPosX());
+        static int emitThreads = theApp->getEmitThreads();
+        ImGui::SliderInt("##threads", &emitThreads, 1, std::max(int(std::thread::hardware_concurrency()), 1));
+        ImGui::PopItemWidth();
 
+        ImGui::AlignTextToFramePadding();
+        ImGui::TextDisabled("Vertex:"); 
+        ImGui::SameLine(); 
+        ImGui::PushItemWidth(wButt*.5 -ImGui::GetCursorPosX() - border);
+        ImGui::Combo("##vtxFmt", &vtxFormat, "float 16B\0half 8B\0unorm16 8B\0");
         ImGui::PopItemWidth();
+        ImGui::SameLine(wButt*.5 + border); 
+        ImGui::TextDisabled("(at restart)"); 
 
 
 
@@ -1511,6 +1586,7 @@ void progSettingDlgClass::view()
             theApp->setPosX(x);
             theApp->setPosY(y);
             theApp->setMaxAllocatedBuffer(maxBuff * 1000000.f);
+            theApp->setEmitThreads(emitThreads);
             theApp->saveProgConfig();
         }
 
@@ -1602,6 +1678,32 @@ void dataDlgClass::view()
 
         if(ImGui::Button("Load Data", ImVec2(wButt,0))) loadObjFile();
 
+        if(ImGui::Button("Load Points", ImVec2(wButt/2,0))) loadPointsFile();
+        ImGui::SameLine();
+        if(ImGui::Button("Save Points", ImVec2(wButt/2,0))) savePointsFile();
+
+        static bool plyBinary = true, plyColor = false;
+        if(ImGui::Button("Load PLY", ImVec2(wButt/2,0))) loadPlyFile();
+        ImGui::SameLine();
+        const float plyProgress = getPlyExportProgress();
+        if(plyProgress<0.f) { if(ImGui::Button("Save PLY", ImVec2(wButt/2,0))) savePlyFile(plyBinary, plyColor); }
+        else ImGui::ProgressBar(plyProgress, ImVec2(wButt/2,0));
+        ImGui::Checkbox("binary##ply", &plyBinary);
+        ImGui::SameLine();
+        ImGui::Checkbox("rgb from w##ply", &plyColor);
+        ImGui::SameLine();
+        ShowHelpMarker("Save PLY: red green blue of loaded data (packed in w), else speed");
+
+        static int archiveDigits = 5;
+        if(ImGui::Button("Load Archive", ImVec2(wButt/2,0))) loadArchiveFile();
+        ImGui::SameLine();
+        if(ImGui::Button("Save Archive", ImVec2(wButt/2,0))) saveArchiveFile(powf(10.f, -float(archiveDigits)));
+        ImGui::PushItemWidth(wButt/2);
+        ImGui::SliderInt("##archiveErr", &archiveDigits, 2, 7, "max error 1e-%d");
+        ImGui::PopItemWidth();
+        ImGui::SameLine();
+        ShowHelpMarker("Save Archive: compressed points, max error relative to attractor size");
+
         if(ImGui::Button("Save CFG", ImVec2(wButt/2,0))) saveSettingsFile();
         ImGui::SameLine();
         if(ImGui::Button("Load CFG", ImVec2(wButt/2,0))) loadSettingsFile();
@@ -44,6 +44,10 @@ void fillAttractorData();
 void writePalette(const char *filename, int idx);
 
 class particlesBaseClass;
+class AttractorBase;
+class attractorDtType;
+class PowerN3D;
+class Magnetic;
 
 #define DLG_BORDER_SIZE 2
 #define INDENT(x) ((x)+border+2)
@@ -97,6 +101,15 @@ public:
     void view();
 
 private:
+    //additional data of attractors: dt step, order, # elements
+    int additionalDataDlg(AttractorBase *att);
+    void additionalDataCtrls(AttractorBase *att);
+    void additionalDataCtrls(attractorDtType *att);
+    void additionalDataCtrls(PowerN3D *att);
+    void additionalDataCtrls(Magnetic *att);
+    //precision of transcendental functions: exact / fast / fastest
+    void mathPrecisionCtrls(AttractorBase *att);
+
     int numElements;
 };
 
@@ -38,6 +38,10 @@
 #include <iomanip>
 #include <chrono>
 #include <vector>
+#include <deque>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
 #include "glslProgramObject.h"
 #include "glslShaderObject.h"
 #include "appDefines.h"
@@ -75,22 +79,30 @@ public:
         delete [] vtxBuffer;
     }
 
-    GLfloat* getBuffer()  { return vtxBuffer; }
+    GLfloat* getBuffer(int block = 0)  { return (GLfloat *) ((GLubyte *) vtxBuffer + block * nVtxStepBuffer * bytesPerVertex); }
     int      getBytesPerVertex() { return bytesPerVertex; }
     int      getNumComponents()  { return COMPONENTS_PER_ATTRIBUTE * attributesPerVertex; }
     int      getAttribPerVtx()  { return attributesPerVertex; }
     GLuint64 getVertexUploaded() { return uploadedVtx; }
-    GLuint64 *getPtrVertexUploaded() { return &uploadedVtx; }
+    std::atomic<GLuint64> *getPtrVertexUploaded() { return &uploadedVtx; }
     void     incVertexCount() { uploadedVtx++;  }
     void     resetVertexCount()  { uploadedVtx = 0; }
     GLuint   getVBO()            { return vbo; };
     GLenum   getPrimitive() { return primitive; }
 
+    //packed attribute (before initBufferStorage): GL_HALF_FLOAT or normalized GL_UNSIGNED_SHORT
+    void setAttribFormat(GLenum type, GLboolean normalized) {
+        attribType = type; attribNormalized = normalized;
+        const int szComponent = type == GL_FLOAT ? sizeof(GLfloat) : sizeof(GLushort);
+        bytesPerVertex = attributesPerVertex * COMPONENTS_PER_ATTRIBUTE * szComponent;
+    }
+
     void ActivateClientStates()  {
 #if !defined(GLAPP_REQUIRE_OGL45)
         glBindBuffer(GL_ARRAY_BUFFER,vbo);
+        const GLuint szAttrib = bytesPerVertex / attributesPerVertex;
         for(int i =0; i<attributesPerVertex; i++) {
-            glVertexAttribPointer(i, COMPONENTS_PER_ATTRIBUTE, GL_FLOAT, GL_FALSE,bytesPerVertex, (GLvoid *) (i*COMPONENTS_PER_ATTRIBUTE*sizeof(float))); 
+            glVertexAttribPointer(i, COMPONENTS_PER_ATTRIBUTE, attribType, attribNormalized,bytesPerVertex, (GLvoid *) (size_t(i)*szAttrib)); 
             glEnableVertexAttribArray(i);
         } 
 #endif
@@ -107,7 +119,7 @@ public:
 #ifdef GLAPP_REQUIRE_OGL45
         const int locID = 0;
         glVertexArrayAttribBinding(vao,locID, 0);
-        glVertexArrayAttribFormat(vao, locID, COMPONENTS_PER_ATTRIBUTE, GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribFormat(vao, locID, COMPONENTS_PER_ATTRIBUTE, attribType, attribNormalized, 0);
         glEnableVertexArrayAttrib(vao, locID);        
 
         glVertexArrayVertexBuffer(vao, 0, vbo, 0, bytesPerVertex);
@@ -119,7 +131,11 @@ public:
     }
 
 
-    virtual bool uploadSubBuffer(GLuint nVtx, GLuint szCircularBuff) 
+    //upload nVtx from staging block to circular buffer: true if wrapped
+    bool uploadSubBuffer(GLuint nVtx, GLuint szCircularBuff, int block = 0) { return uploadVertices(getBuffer(block), nVtx, szCircularBuff); }
+
+    //upload nVtx (bytesPerVertex each) from src to circular buffer: true if wrapped
+    virtual bool uploadVertices(const void *src, GLuint nVtx, GLuint szCircularBuff) 
     {
         const GLuint offset = uploadedVtx % szCircularBuff;
         const GLuint offByte = offset * bytesPerVertex;
@@ -132,22 +148,22 @@ public:
            
             //cout << szPart1 << " - " << szPart2 << endl;
 #ifdef GLAPP_REQUIRE_OGL45
-            glNamedBufferSubData(vbo, offByte, szPart1, vtxBuffer);
-            glNamedBufferSubData(vbo, 0      , szPart2, (GLubyte *) vtxBuffer + szPart1); 
+            glNamedBufferSubData(vbo, offByte, szPart1, src);
+            glNamedBufferSubData(vbo, 0      , szPart2, (GLubyte *) src + szPart1); 
         } else {
             //cout << offByte << " - " << nVtx << endl;
             //glBindBuffer(GL_ARRAY_BUFFER,vbo);
             //glBufferSubData(GL_ARRAY_BUFFER, offByte, nVtx * bytesPerVertex, vtxBuffer); 
 
-            glNamedBufferSubData(vbo, offByte, nVtx * bytesPerVertex, vtxBuffer); 
+            glNamedBufferSubData(vbo, offByte, nVtx * bytesPerVertex, src); 
         }
 #else
             glBindBuffer(GL_ARRAY_BUFFER,vbo);
-            glBufferSubData(GL_ARRAY_BUFFER, offByte, szPart1, vtxBuffer);
-            glBufferSubData(GL_ARRAY_BUFFER, 0      , szPart2, (GLubyte *) vtxBuffer + szPart1); 
+            glBufferSubData(GL_ARRAY_BUFFER, offByte, szPart1, src);
+            glBufferSubData(GL_ARRAY_BUFFER, 0      , szPart2, (GLubyte *) src + szPart1); 
         } else {
             glBindBuffer(GL_ARRAY_BUFFER,vbo);
-            glBufferSubData(GL_ARRAY_BUFFER, offByte, nVtx * bytesPerVertex, vtxBuffer); 
+            glBufferSubData(GL_ARRAY_BUFFER, offByte, nVtx * bytesPerVertex, src); 
         }
         glBindBuffer(GL_ARRAY_BUFFER,0);
 #endif
@@ -156,13 +172,32 @@ public:
         return retVal;
     }
 
+    //nVtx vertices from first (no wrap) to dst: render loop
+    void readVertices(void *dst, GLuint first, GLuint nVtx) {
+#ifdef GLAPP_REQUIRE_OGL45
+        glGetNamedBufferSubData(vbo, GLintptr(first) * bytesPerVertex, GLsizeiptr(nVtx) * bytesPerVertex, dst);
+#else
+        glBindBuffer(GL_ARRAY_BUFFER,vbo);
+        glGetBufferSubData(GL_ARRAY_BUFFER, GLintptr(first) * bytesPerVertex, GLsizeiptr(nVtx) * bytesPerVertex, dst);
+        glBindBuffer(GL_ARRAY_BUFFER,0);
+#endif
+    }
+
+    //ranges of drawn vertices (max 2) in first/count: returns number of ranges
+    virtual int getDrawRanges(GLuint maxSize, GLuint *first, GLuint *count) {
+        first[0] = 0; 
+        count[0] = GLuint(std::min(uploadedVtx.load(), GLuint64(maxSize)));
+        return count[0] ? 1 : 0;
+    }
+
     void draw(GLuint maxSize) {
+        const GLuint64 nVtx = uploadedVtx;
 #ifdef GLAPP_REQUIRE_OGL45
         glBindVertexArray(vao);
-        glDrawArrays(primitive,0, uploadedVtx<maxSize ? uploadedVtx : maxSize);
+        glDrawArrays(primitive,0, nVtx<maxSize ? nVtx : maxSize);
 #else
         ActivateClientStates();
-        glDrawArrays(primitive,0,uploadedVtx<maxSize ? uploadedVtx : maxSize);
+        glDrawArrays(primitive,0,nVtx<maxSize ? nVtx : maxSize);
         DeactivateClientStates();
         CHECK_GL_ERROR();
 #endif
@@ -197,12 +232,35 @@ protected:
     int attributesPerVertex;
     GLuint vbo,vao;
     GLuint nVtxStepBuffer;
+    GLuint nStagingBlocks = 1;        //CPU staging blocks of nVtxStepBuffer vertices
     GLuint bytesPerVertex;           //Total bytes per Vertex: all attributes!
+    GLenum attribType = GL_FLOAT;
+    GLboolean attribNormalized = GL_FALSE;
     //GLuint64 uploadedDataSize;
-    GLuint64 uploadedVtx;
+    std::atomic<GLuint64> uploadedVtx;
     GLenum primitive;
 };
 
+//  Persistent mapped circular buffer as ring of MAPPED_SEGMENTS segments: step
+//  thread writes only in [uploadedVtx, writeLimit) and render loop never draws
+//  this window. Render loop reserves it, MAPPED_SEGMENTS_AHEAD segments beyond
+//  uploadedVtx, and grants all reserved segments not drawn by frames in
+//  flight: fence of each frame (w/ its reserved limit) is polled, no wait, so
+//  neither side stalls the other.
+//  USE_MAPPED_FLUSH_EXPLICIT: non coherent map, written ranges are flushed by
+//  render loop before draw
+////////////////////////////////////////////////////////////////////////////
+#define MAPPED_SEGMENTS 32
+#define MAPPED_SEGMENTS_AHEAD 2
+
+#ifdef USE_MAPPED_FLUSH_EXPLICIT
+    #define MAPPED_BUFFER_FLAGS (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT)
+    #define MAPPED_RANGE_FLAGS  (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT)
+#else
+    #define MAPPED_BUFFER_FLAGS (GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)
+    #define MAPPED_RANGE_FLAGS  MAPPED_BUFFER_FLAGS
+#endif
+
 class mappedVertexBuffer : public vertexBufferBaseClass
 {
 public:
@@ -211,8 +269,10 @@ public:
         vertexBufferBaseClass(primitive, numVertex, attributesPerVertex) { }
 
     ~mappedVertexBuffer() {
+        for(auto &f : frameFences) glDeleteSync(f.fence);
 #ifdef GLAPP_REQUIRE_OGL45
         glUnmapNamedBuffer(vbo);
+        vtxBuffer = nullptr;
 #else
         //glBindBuffer(GL_ARRAY_BUFFER,vbo);        
         //glUnmapBuffer(GL_ARRAY_BUFFER);
@@ -223,8 +283,8 @@ public:
         GLsizeiptr storageSize = nVtx * bytesPerVertex;
 
 #ifdef GLAPP_REQUIRE_OGL45
-        glNamedBufferStorage(vbo, storageSize, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT); // ); //  
-        vtxBuffer = (GLfloat *) glMapNamedBufferRange(vbo, 0, storageSize, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);   //
+        glNamedBufferStorage(vbo, storageSize, nullptr, MAPPED_BUFFER_FLAGS); // ); //  
+        vtxBuffer = (GLfloat *) glMapNamedBufferRange(vbo, 0, storageSize, MAPPED_RANGE_FLAGS);   //
 #else
         //glBindBuffer(GL_ARRAY_BUFFER,vbo); 
         //glBufferData(GL_ARRAY_BUFFER, storageSize, nullptr, GL_DYNAMIC_DRAW ); // ); //
@@ -233,30 +293,262 @@ public:
         buildVertexAttrib();
     }
 
+    // step thread: writable up to getWriteLimit()
+    bool isWritable() { return uploadedVtx.load(std::memory_order_acquire) < writeLimit.load(std::memory_order_acquire); }
+    GLuint64 getWriteLimit() { return writeLimit.load(std::memory_order_acquire); }
+
+    // restart ring: step thread must be stopped, or waiting
+    void resetVertexCount() {
+        uploadedVtx = 0; flushedVtx = 0;
+        writeLimit = 0; reservedLimit = 0;
+        // frames in flight can draw whole ring: nothing granted before signaled
+        for(auto &f : frameFences) f.limit = 0;
+    }
+
+    // render loop, before draw: flush written range, reserve segments and
+    // grant all ones not drawn by frames in flight, true if writeLimit is extended
+    bool updateWriteRange(GLuint szCircularBuff) {
+        const GLuint64 uploaded = uploadedVtx.load(std::memory_order_acquire);
+#ifdef USE_MAPPED_FLUSH_EXPLICIT
+        flushRange(flushedVtx, uploaded, szCircularBuff);
+        flushedVtx = uploaded;
+#endif
+        // reserved window is excluded from this frame draw, a frame in flight
+        // has excluded only up to its limit: vertices beyond overwrite ones it draws
+        const GLuint64 szSegment = std::max(szCircularBuff / MAPPED_SEGMENTS, 1u);
+        reservedLimit = std::max(reservedLimit, (uploaded / szSegment + 1 + MAPPED_SEGMENTS_AHEAD) * szSegment);
+        releaseFrames();
+        const GLuint64 limit = frameFences.empty() ? reservedLimit : std::min(reservedLimit, frameFences.front().limit);
+        if(limit <= writeLimit.load(std::memory_order_relaxed)) return false;
+        writeLimit.store(limit, std::memory_order_release);
+        return true;
+    }
+
+    // render loop w/ step thread stopped (imports): copy in ring, GPU must be
+    // idle on it, not drawn window ends at these vertices
+    bool uploadVertices(const void *src, GLuint nVtx, GLuint szCircularBuff) {
+        const GLuint64 uploaded = uploadedVtx.load(std::memory_order_acquire);
+        const GLuint offset = uploaded % szCircularBuff;
+        const GLuint nPart1 = std::min(nVtx, szCircularBuff - offset);
+        memmove((GLubyte *) vtxBuffer + GLsizeiptr(offset) * bytesPerVertex, src, GLsizeiptr(nPart1) * bytesPerVertex);
+        if(nVtx > nPart1) 
+            memmove(vtxBuffer, (const GLubyte *) src + GLsizeiptr(nPart1) * bytesPerVertex, GLsizeiptr(nVtx - nPart1) * bytesPerVertex);
+#ifdef USE_MAPPED_FLUSH_EXPLICIT
+        flushRange(uploaded, uploaded + nVtx, szCircularBuff);
+        flushedVtx = uploaded + nVtx;
+#endif
+        uploadedVtx.store(uploaded + nVtx, std::memory_order_release);
+        reservedLimit = std::max(reservedLimit, uploaded + nVtx);
+        return offset + nVtx >= szCircularBuff;
+    }
+
+    // render loop, after draw
+    void fenceFrame() {
+        releaseFrames();
+        frameFences.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), reservedLimit });
+    }
+
+    // all emitted vertices, less the window reserved to step thread
+    int getDrawRanges(GLuint maxSize, GLuint *first, GLuint *count) {
+        const GLuint64 uploaded = uploadedVtx.load(std::memory_order_acquire);
+        int n = 0;
+        auto addRange = [&](GLuint64 f, GLuint64 c) { if(c) { first[n] = GLuint(f); count[n++] = GLuint(c); } };
+        if(uploaded < maxSize) {
+            // first lap: reserved window can wrap on first vertices
+            const GLuint64 from = reservedLimit > maxSize ? reservedLimit - maxSize : 0;
+            addRange(from, uploaded - from);
+            return n;
+        }
+        const GLuint start = uploaded % maxSize;
+        const GLuint64 end = start + std::min(reservedLimit - uploaded, GLuint64(maxSize));
+        if(end <= maxSize) {
+            addRange(0, start);
+            addRange(end, maxSize - end);
+        } else {
+            addRange(end - maxSize, start - (end - maxSize));
+        }
+        return n;
+    }
+
+    void draw(GLuint maxSize) {
+        GLuint first[2], count[2];
+        const int n = getDrawRanges(maxSize, first, count);
+        glBindVertexArray(vao);
+        for(int i=0; i<n; i++) glDrawArrays(primitive, first[i], count[i]);
+    }
+
+private:
+    // fences of frames in flight are in order: drop signaled ones
+    void releaseFrames() {
+        while(!frameFences.empty()) {
+            // timeout 0: poll only, flush bit makes sure fence reaches GPU
+            if(glClientWaitSync(frameFences.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) return;
+            glDeleteSync(frameFences.front().fence);
+            frameFences.pop_front();
+        }
+    }
+#ifdef USE_MAPPED_FLUSH_EXPLICIT
+    void flushRange(GLuint64 from, GLuint64 to, GLuint szCircularBuff) {
+        if(to <= from) return;
+        if(to - from >= szCircularBuff) { from = to - szCircularBuff; }
+        const GLuint start = from % szCircularBuff;
+        const GLuint64 end = start + (to - from);
+        if(end <= szCircularBuff) 
+            glFlushMappedNamedBufferRange(vbo, start * bytesPerVertex, (end - start) * bytesPerVertex);
+        else {
+            glFlushMappedNamedBufferRange(vbo, start * bytesPerVertex, (szCircularBuff - start) * bytesPerVertex);
+            glFlushMappedNamedBufferRange(vbo, 0, (end - szCircularBuff) * bytesPerVertex);
+        }
+    }
+#endif
+    std::atomic<GLuint64> writeLimit { 0 };
+    GLuint64 reservedLimit = 0, flushedVtx = 0;     // render loop only
+    struct frameFence { GLsync fence; GLuint64 limit; };
+    std::deque<frameFence> frameFences;
 
 };
 
+//  Staging blocks for threaded upload (USE_THREAD_TO_FILL w/o mapped buffer):
+//  ownership by single producer / single consumer indices, the step thread
+//  fills block "head", blocks [tail, head) are ready for the render loop,
+//  any other block is free
+#define STAGING_BLOCKS 3
+
 class vertexBuffer : public vertexBufferBaseClass 
 {
 public:
-    vertexBuffer(GLenum primitive, int numVertex, int attributesPerVertex) : 
-        vertexBufferBaseClass(primitive, numVertex, attributesPerVertex) { }
+    vertexBuffer(GLenum primitive, int numVertex, int attributesPerVertex, int stagingBlocks = 1) : 
+        vertexBufferBaseClass(primitive, numVertex, attributesPerVertex), stagingCount(stagingBlocks) 
+    { 
+        nStagingBlocks = stagingBlocks; 
+    }
+
+    // step thread: fill getStagingBlock() if isStagingFree(), then publish it
+    bool isStagingFree() { 
+        return stagingHead.load(std::memory_order_acquire) - stagingTail.load(std::memory_order_acquire) < nStagingBlocks; 
+    }
+    GLfloat *getStagingBlock() { return getBuffer(stagingHead.load(std::memory_order_relaxed) % nStagingBlocks); }
+    void publishStaging(GLuint nVtx) {
+        const GLuint head = stagingHead.load(std::memory_order_relaxed);
+        stagingCount[head % nStagingBlocks] = nVtx;
+        stagingHead.store(head+1, std::memory_order_release);
+    }
+
+    // render loop: upload all ready blocks, each one is released as soon as
+    // copied by glBufferSubData; stops at end of circular buffer (true)
+    bool uploadStaging(GLuint szCircularBuff) {
+        const GLuint head = stagingHead.load(std::memory_order_acquire);
+        GLuint tail = stagingTail.load(std::memory_order_relaxed);
+        bool bufferFull = false;
+        while(tail != head && !bufferFull) {
+            const int block = tail % nStagingBlocks;
+            bufferFull = uploadSubBuffer(stagingCount[block], szCircularBuff, block);
+            stagingTail.store(++tail, std::memory_order_release);
+        }
+        return bufferFull;
+    }
+    // render loop: discard ready blocks
+    void flushStaging() { stagingTail.store(stagingHead.load(std::memory_order_acquire), std::memory_order_release); }
 
     void initBufferStorage(GLsizeiptr nVtx) {
         GLsizeiptr storageSize = nVtx * bytesPerVertex;
 
 #ifdef GLAPP_REQUIRE_OGL45
-        vtxBuffer = new GLfloat[nVtxStepBuffer * attributesPerVertex * COMPONENTS_PER_ATTRIBUTE];
+        vtxBuffer = new GLfloat[nStagingBlocks * nVtxStepBuffer * bytesPerVertex / sizeof(GLfloat)];
         glNamedBufferStorage(vbo, storageSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
         //glNamedBufferData(vbo, storageSize,nullptr,GL_DYNAMIC_DRAW);
 #else
-        vtxBuffer = new GLfloat[nVtxStepBuffer * attributesPerVertex * COMPONENTS_PER_ATTRIBUTE];
+        vtxBuffer = new GLfloat[nStagingBlocks * nVtxStepBuffer * bytesPerVertex / sizeof(GLfloat)];
         glBindBuffer(GL_ARRAY_BUFFER,vbo);        
         glBufferData(GL_ARRAY_BUFFER,storageSize,nullptr,GL_DYNAMIC_DRAW);
 #endif
 
         buildVertexAttrib();
     }
+
+private:
+    std::vector<GLuint> stagingCount;
+    std::atomic<GLuint> stagingHead { 0 }, stagingTail { 0 };
+};
+
+//  GPU copy of the drawn vertices, for background export: read back in
+//  chunks by render loop, once the fence of the copy is signaled (polled)
+class snapshotBuffer
+{
+public:
+    ~snapshotBuffer() { release(); }
+
+    //copy of src drawn vertices: returns vertices copied (0 out of memory)
+    GLuint create(vertexBufferBaseClass *src, GLuint maxSize) {
+        release();
+        GLuint first[2], count[2];
+        const int nRanges = src->getDrawRanges(maxSize, first, count);
+        bytesPerVertex = src->getBytesPerVertex();
+        nVtx = 0;
+        for(int i=0; i<nRanges; i++) nVtx += count[i];
+        if(!nVtx) return 0;
+
+        while(glGetError() != GL_NO_ERROR);
+#ifdef GLAPP_REQUIRE_OGL45
+        glCreateBuffers(1, &buffer);
+        glNamedBufferStorage(buffer, GLsizeiptr(nVtx) * bytesPerVertex, nullptr, 0);
+#else
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(nVtx) * bytesPerVertex, nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_COPY_READ_BUFFER, src->getVBO());
+#endif
+        if(glGetError() == GL_OUT_OF_MEMORY) { release(); return nVtx = 0; }
+
+        GLintptr dst = 0;
+        for(int i=0; i<nRanges; i++) {
+            const GLsizeiptr size = GLsizeiptr(count[i]) * bytesPerVertex;
+#ifdef GLAPP_REQUIRE_OGL45
+            glCopyNamedBufferSubData(src->getVBO(), buffer, GLintptr(first[i]) * bytesPerVertex, dst, size);
+#else
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GLintptr(first[i]) * bytesPerVertex, dst, size);
+#endif
+            dst += size;
+        }
+#if !defined(GLAPP_REQUIRE_OGL45)
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+#endif
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return nVtx;
+    }
+
+    //copy completed: poll only
+    bool isReady() {
+        if(fence) {
+            if(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED) return false;
+            glDeleteSync(fence); fence = nullptr;
+        }
+        return buffer != 0;
+    }
+
+    void read(void *dst, GLuint first, GLuint n) {
+#ifdef GLAPP_REQUIRE_OGL45
+        glGetNamedBufferSubData(buffer, GLintptr(first) * bytesPerVertex, GLsizeiptr(n) * bytesPerVertex, dst);
+#else
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, GLintptr(first) * bytesPerVertex, GLsizeiptr(n) * bytesPerVertex, dst);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+#endif
+    }
+
+    void release() {
+        if(fence) glDeleteSync(fence);
+        if(buffer) glDeleteBuffers(1, &buffer);
+        fence = nullptr; buffer = 0;
+    }
+
+    GLuint getSize() { return nVtx; }
+    GLuint getBytesPerVertex() { return bytesPerVertex; }
+
+private:
+    GLuint buffer = 0, nVtx = 0, bytesPerVertex = 0;
+    GLsync fence = nullptr;
 };
 
 